@@ -30,6 +30,23 @@ extern "C"
 
 #include "bcdfloat.h"
 
+/* quotient by BASE for the limb loops. `v' is non-negative.
+ * where there's a 64 bit type, multiply by the reciprocal 
+ * 0xD1B71759/2^45 instead, exact for all 32 bit unsigned values.
+ * a build can define its own, eg. to time the plain divide.
+ */
+#ifdef DIVBASE
+// given
+#elif defined(_WIN32)
+#define DIVBASE(_v) \
+    ((int4)(((unsigned __int64)(uint4)(_v)*0xD1B71759u) >> 45))
+#elif defined(__GNUC__)
+#define DIVBASE(_v) \
+    ((int4)(((unsigned long long)(uint4)(_v)*0xD1B71759u) >> 45))
+#else
+#define DIVBASE(_v) ((_v)/BASE)
+#endif
+
 #ifdef _WIN32
 #include <stdio.h>
 void dump(const BCDFloat& v)
@@ -564,6 +581,72 @@ void bcd_sub(const unsigned short* a,
     bcd_op_fin(&op);
 }
 
+static void bcd_mulw(const unsigned short* a, int pa,
+                     const unsigned short* b, int pb,
+                     unsigned short* w)
+{
+    // full product of mantissas `a' and `b' into `w', pa+pb terms.
+    // w[0] receives the overall carry.
+    //
+    // products are summed by column without carry and the carries
+    // normalised once at the end. a column holds at most min(pa,pb)
+    // terms of 9999*9999, which fits 32 bits unsigned for up to 42
+    // terms, way more than MAX_P.
+
+    uint4 acc[MAX_P*2];
+    uint4 u, v, ca;
+    int i, j;
+    int nw = pa + pb;
+
+    if (nw > MAX_P*2)
+    {
+        // long operands (variable precision), carry as we go.
+        CLEAR(w + pa, pb);
+        for (i = pa-1; i >= 0; --i)
+        {
+            ca = 0;
+            u = a[i];
+            if (u)
+            {
+                unsigned short* wp = w + i + 1;
+                for (j = pb-1; j >= 0; --j)
+                {
+                    v = b[j]*u + wp[j] + ca;
+                    ca = DIVBASE(v);
+                    wp[j] = v - ca*BASE;
+                }
+            }
+            w[i] = ca;
+        }
+        return;
+    }
+
+    for (i = 0; i < nw; ++i) acc[i] = 0;
+
+    for (i = 0; i < pa; ++i)
+    {
+        u = a[i];
+        if (u)
+        {
+            uint4* ap = acc + i + 1;
+            for (j = 0; j < pb; ++j) ap[j] += b[j]*u;
+        }
+    }
+
+    ca = 0;
+    for (i = nw-1; i >= 0; --i)
+    {
+        v = acc[i] + ca;
+        ca = 0;
+        if (v >= BASE)
+        {
+            ca = DIVBASE(v);
+            v = v - ca*BASE;
+        }
+        w[i] = v;
+    }
+}
+
 int bcd_op_mul(bcd_op* op)
 {
     // pa <= pb
@@ -604,46 +687,14 @@ int bcd_op_mul(bcd_op* op)
         }
         else
         {
-            int ca;
-            int i, j;
-            int4 u, v;
+            int i;
 
             // will build the product in the `op' workspace.
             // this must be enough for pa + pb terms
 
             unsigned short* w = op->ws;
-            int pb = op->pb;
-            i = op->pa;
-            w += i;
-            CLEAR(w, pb);  // need only clear pb terms
-
-            int nw = i + pb;
-
-            --i;
-            for (;;)
-            {
-                ca = 0;
-                u = op->a[i];
-                if (u)
-                {
-                    for (j = pb-1; j >= 0; --j) 
-                    {
-                        v = op->b[j]*u + w[j] + ca;
-                        ca = 0;
-                        if (v >= BASE) 
-                        {
-                            ca = v / BASE;
-                            v = v - ca*BASE;
-                        }
-                        w[j] = v;
-                    }
-                }
-
-                *--w = ca;
-
-                if (!i) break;
-                --i;
-            }
+            int nw = op->pa + op->pb;
+            bcd_mulw(op->a, op->pa, op->b, op->pb, w);
 
             // `w' now points to start of product
 
@@ -754,10 +805,6 @@ void bcd_fma(const unsigned short* a,
 
     if (!az && !bz)
     {        
-        int ca;
-        int i, j;
-        int4 u, v;
-
         int ea = GET_EXP(a,pn);
         int eb = GET_EXP(b,pn);
         int ed = GET_EXP(d,pn);
@@ -774,34 +821,8 @@ void bcd_fma(const unsigned short* a,
 
             int pn2 = 2*pn-1;
 
-            // clear acc 
             // acc is shifted by 1 to allow carry
-            for (i = pn2; i >= 0; --i) acc[i] = 0;
-
-            i = pn-1;
-            for (;;)
-            {
-                u = a[i];
-                if (u)
-                {
-                    ca = 0;
-                    for (j = pn; j > 0; --j) 
-                    {
-                        v = b[j-1]*u + acc[i+j] + ca; // acc is +1 for carry
-                        ca = 0;
-                        if (v >= BASE) 
-                        {
-                            ca = v / BASE;
-                            v = v - ca*BASE;
-                        }
-                        acc[i+j] = v;
-                    }
-                    acc[i] = ca; // acc carry
-                }
-            
-                if (!i) break;
-                --i;
-            }
+            bcd_mulw(a, pn, b, pn, acc);
 
             /// find first significant digit
             int a0 = 0;
@@ -941,7 +962,7 @@ int bcd_op_div(bcd_op* op)
                 ca = 0;
                 if (v >= BASE) 
                 {
-                    ca = v/BASE;
+                    ca = DIVBASE(v);
                     v -= ca*BASE;
                 }
                 acc[i] = v;
@@ -956,7 +977,7 @@ int bcd_op_div(bcd_op* op)
                 ca = 0;
                 if (v >= BASE) 
                 {
-                    ca = v/BASE;
+                    ca = DIVBASE(v);
                     v -= ca*BASE;
                 }
                 b1[i] = v;
@@ -1011,7 +1032,7 @@ int bcd_op_div(bcd_op* op)
                     ca = 0;
                     if (v < 0) 
                     {
-                        ca = (-v + BASE-1)/BASE;
+                        ca = DIVBASE(-v + BASE-1);
                         v += ca*BASE;
                     }
                     acc[i] = v;
@@ -1078,6 +1099,127 @@ void bcd_div(const unsigned short* a,
     bcd_op_fin(&op);
 }
 
+/* batch versions.
+ *
+ * these apply the operation elementwise over `n' P sized values,
+ * c[i] = a[i] op b[i]. one `bcd_op' and one workspace serve the whole
+ * run. the sizes and workspace are set once, each element only loads
+ * its operands and exponents. each element goes through the same
+ * kernels as the scalar calls, so results are identical. like the
+ * scalar calls, the kernels write `c' while still reading `a' and
+ * `b', so `c' must not overlap either.
+ */
+
+static void bcd_op_next(bcd_op* op,
+                        const unsigned short* a, const unsigned short* b,
+                        unsigned short* c)
+{
+    // next batch element. all sizes are P, so a swap leaves them
+    op->a = a;
+    op->b = b;
+    op->c = c;
+    op->pc = P;
+    op->ea = GET_EXP(a, P);
+    op->eb = GET_EXP(b, P);
+    op->ec = op->ea;
+}
+
+static void bcd_op_round(bcd_op* op, int rd)
+{
+    // round to nearest & finish
+    if (rd >= BASE/2)
+        if (bcd_bup(op->c, op->pc))
+            ++op->ec;
+
+    bcd_op_fin(op);
+}
+
+void bcd_add_n(const BCDFloatData* a,
+               const BCDFloatData* b,
+               BCDFloatData* c,
+               int n)
+{
+    bcd_op op;
+    op.pa = P;
+    op.pb = P;
+    while (n > 0)
+    {
+        bcd_op_next(&op, a->_d, b->_d, c->_d);
+        int rd = bcd_op_addsub(&op, false);
+        op.pc = op.pa;
+        bcd_op_round(&op, rd);
+        ++a; ++b; ++c; --n;
+    }
+}
+
+void bcd_sub_n(const BCDFloatData* a,
+               const BCDFloatData* b,
+               BCDFloatData* c,
+               int n)
+{
+    bcd_op op;
+    op.pa = P;
+    op.pb = P;
+    while (n > 0)
+    {
+        bcd_op_next(&op, a->_d, b->_d, c->_d);
+        int rd = bcd_op_addsub(&op, true);
+        op.pc = op.pa;
+        bcd_op_round(&op, rd);
+        ++a; ++b; ++c; --n;
+    }
+}
+
+void bcd_mul_n(const BCDFloatData* a,
+               const BCDFloatData* b,
+               BCDFloatData* c,
+               int n)
+{
+    unsigned short tmp[2*P];
+    bcd_op op;
+    op.pa = P;
+    op.pb = P;
+    op.ws = tmp;
+    while (n > 0)
+    {
+        bcd_op_next(&op, a->_d, b->_d, c->_d);
+        bcd_op_round(&op, bcd_op_mul(&op));
+        ++a; ++b; ++c; --n;
+    }
+}
+
+void bcd_div_n(const BCDFloatData* a,
+               const BCDFloatData* b,
+               BCDFloatData* c,
+               int n)
+{
+    unsigned short tmp[2*P+5];
+    bcd_op op;
+    op.pa = P;
+    op.pb = P;
+    op.ws = tmp;
+    while (n > 0)
+    {
+        bcd_op_next(&op, a->_d, b->_d, c->_d);
+        bcd_op_round(&op, bcd_op_div(&op));
+        ++a; ++b; ++c; --n;
+    }
+}
+
+void bcd_fma_n(const BCDFloatData* a,
+               const BCDFloatData* b,
+               const BCDFloatData* d,
+               BCDFloatData* c,
+               int n)
+{
+    // c[i] = a[i]*b[i] + d[i], bcd_fma has no setup to share
+    while (n > 0)
+    {
+        bcd_fma(a->_d, b->_d, d->_d, c->_d, P);
+        ++a; ++b; ++d; ++c; --n;
+    }
+}
+
 int bcd_cmp(const unsigned short* a, 
             const unsigned short* b,
             int pa, int pb)
@@ -1817,7 +1959,7 @@ bool BCDFloat::sqrt(const BCDFloat* a, BCDFloat* r)
                 ca = 0;
                 if (v >= BASE) 
                 {
-                    ca = v/BASE;
+                    ca = DIVBASE(v);
                     v -= ca*((int4)BASE);
                 }
                 t[i] = v;
@@ -1871,7 +2013,7 @@ bool BCDFloat::sqrt(const BCDFloat* a, BCDFloat* r)
                         ca = 0;
                         if (v >= BASE) 
                         {
-                            ca = v/BASE;
+                            ca = DIVBASE(v);
                             v -= ca*((int4)BASE);
                         }
                         u[i] = v;
@@ -2026,7 +2168,7 @@ void BCDFloat::mul2(const unsigned short* ad, int ea,
             ca = 0;
             if (v >= BASE) 
             {
-                ca = v / BASE;
+                ca = DIVBASE(v);
                 v = v - ca*((int4)BASE);
             }
             acc[j] = v;
@@ -193,6 +193,18 @@ int bcd_fromString(unsigned short* d, int pn, const char* s);
 unsigned int isqrt(unsigned int v);
 extern int BCDDecade[4];
 
+// elementwise over arrays of `n' values, c[i] = a[i] op b[i]
+void bcd_add_n(const BCDFloatData* a, const BCDFloatData* b,
+               BCDFloatData* c, int n);
+void bcd_sub_n(const BCDFloatData* a, const BCDFloatData* b,
+               BCDFloatData* c, int n);
+void bcd_mul_n(const BCDFloatData* a, const BCDFloatData* b,
+               BCDFloatData* c, int n);
+void bcd_div_n(const BCDFloatData* a, const BCDFloatData* b,
+               BCDFloatData* c, int n);
+void bcd_fma_n(const BCDFloatData* a, const BCDFloatData* b,
+               const BCDFloatData* d, BCDFloatData* c, int n);
+
 
 struct BCDFloat: public BCDFloatData
 {
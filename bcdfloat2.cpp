@@ -25,55 +25,6 @@
 
 #include "bcdfloat2.h"
 
-void BCDFloat2::_init()
-{
-    for (int i = 0; i <= P2; ++i) _d[i] = 0;
-}
-
-bool BCDFloat2::trunc(const BCDFloat2* a, BCDFloat2* c)
-{
-    /* truncate towards zero.
-     * trunc(2.1) = 2.
-     * trunc(-2.1) = -2
-     */
-    *c = *a;
-    int e = c->exp();
-    int i;
-    for (i = P2-1; i >= 0; --i) 
-        if (i >= e) c->_d[i] = 0;
-
-    return true;
-}
-
-int4 BCDFloat2::asInt() const
-{
-    // if we fit in an int, return it otherwise 0
-    int ea = exp();
-    int4 v = 0;
-    int i = 0;
-    while (i < ea && i < P2) 
-    {
-        if (v > 214748L) return 0; // too large, bail out.
-        v*= BASE;
-        v += _d[i];
-        ++i;
-    }
-    if (neg()) v = -v;
-    return v;
-}
-
-bool BCDFloat2::isInteger() const
-{
-    if (isZero())
-        return true;
-
-    int e = exp();
-    int i;
-    for (i = P2-1; i >= 0; --i) 
-        if (_d[i]) return e > i;
-    return false;
-}
-
 bool BCDFloat2::sqrt(const BCDFloat2* a, BCDFloat2* r)
 {
     // use single precision version as approx.
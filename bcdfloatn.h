@@ -0,0 +1,274 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ * 
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and 
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* body of a BCD float struct of `BCDN_P' 4dec digits.
+ *
+ * because we hate templates, each precision is made by including
+ * this text inside its struct with the following defined,
+ *
+ * BCDN_F       name of the struct
+ * BCDN_DATA    its data base, holding _d[BCDN_P+1]
+ * BCDN_P       number of 4dec digits, a constant
+ *
+ * eg. 
+ * struct BCDFloat2: public BCDFloatData2
+ * {
+ * #define BCDN_F       BCDFloat2
+ * #define BCDN_DATA    BCDFloatData2
+ * #define BCDN_P       P2
+ * #include "bcdfloatn.h"
+ * };
+ *
+ * no include guard, deliberately. the names are undefined at the end.
+ */
+
+    BCDN_F() {} // Warning: not initialised.
+    BCDN_F(int4 v)
+    {
+        _init();
+        if (v)
+        {
+            bool neg = v < 0;
+            if (neg)
+                v = -v;
+            _fromUInt((uint4)v);
+            if (neg) negate();
+        }
+    }
+
+    BCDN_F(uint4 v)
+    {
+        _init();
+        if (v) _fromUInt(v);
+    }
+
+    BCDN_F(const BCDN_DATA& d) { *this = *(BCDN_F*)&d; }
+
+    BCDN_F(const BCDFloatData& d)
+    {
+        int i;
+#if BCDN_P >= P
+        // widen
+        for (i = 0; i < P; ++i) _d[i] = d._d[i];
+        while (i < BCDN_P) _d[i++] = 0;
+        _d[BCDN_P] = d._d[P];
+#else
+        // narrow, rounding on the next digit
+        for (i = 0; i <= BCDN_P; ++i) _d[i] = d._d[i];
+        int e = d._d[P];
+        if (bcd_round(_d, BCDN_P))
+            e = (e & ~EXPMASK) | ((e + 1) & EXPMASK);
+        _d[BCDN_P] = e;
+#endif
+    }
+
+    // Features
+    int                 exp() const { return ((short)(_d[BCDN_P] << 3)) >> 3; }
+    void                exp(int v) { _d[BCDN_P] = v & EXPMASK; }
+    bool                neg() const
+    { return (_d[BCDN_P]& NEG) && (_d[0] != 0 || isInf()); }
+            
+    void                setSign() { _d[BCDN_P] |= NEG; }
+    void                clearSign() { _d[BCDN_P] &= ~NEG; }
+    void                negate() { _d[BCDN_P] ^= NEG; }
+    bool                isSpecial() const { return (_d[BCDN_P]&0x6000) != 0; } 
+
+    bool                isZero() const
+                        { return _d[0] == 0 && !isSpecial(); }
+
+    bool                isNan() const { return (_d[BCDN_P]&0x4000) != 0; }
+    bool                isInf() const { return (_d[BCDN_P]&0x2000) != 0; }
+    bool                isInteger() const
+    {
+        if (isZero())
+            return true;
+
+        int e = exp();
+        int i;
+        for (i = BCDN_P-1; i >= 0; --i) 
+            if (_d[i]) return e > i;
+        return false;
+    }
+
+    void                asBCD(BCDFloat* v) const
+    {
+#if BCDN_P > P
+        for (int i = 0; i <= P; ++i) v->_d[i] = _d[i];
+        bool up = v->_round25() != 0;
+        v->_d[P] = _d[BCDN_P];
+        if (up)
+        {
+            /* the carry moves the point. step the exponent and not
+             * the raw word, which turns -1 into inf. XX overflow?
+             */
+            bool neg = v->neg();
+            v->exp(v->exp() + 1);
+            if (neg) v->setSign();
+        }
+#else
+        v->_init();
+        for (int i = 0; i < BCDN_P; ++i) v->_d[i] = _d[i];
+        v->_d[P] = _d[BCDN_P];
+#endif
+    }
+
+    void                ldexp(unsigned int mant, int e)
+    {
+        // load the exp as a 4-block
+        _init();
+        _fromUInt(mant);
+        exp(e);
+    }
+
+    static void         add(const BCDN_F* a, const BCDN_F* b, BCDN_F* c)
+    {
+        bcd_add(a->_d, b->_d, c->_d, BCDN_P, BCDN_P);
+    }
+    static void         sub(const BCDN_F* a, const BCDN_F* b, BCDN_F* c)
+    {
+        bcd_sub(a->_d, b->_d, c->_d, BCDN_P, BCDN_P);
+    }
+
+    static void         mul(const BCDN_F* a, const BCDN_F* b, BCDN_F* c)
+    {
+        unsigned short tmp[BCDN_P*2];
+        bcd_mul(a->_d, b->_d, c->_d, tmp, BCDN_P, BCDN_P);
+    }
+
+    static void         div(const BCDN_F* a, const BCDN_F* b, BCDN_F* c)
+    {
+        unsigned short tmp[BCDN_P*2+5];
+        bcd_div(a->_d, b->_d, c->_d, tmp, BCDN_P, BCDN_P);
+    }
+
+    void                makeInf()
+    {
+        _init();
+        _d[BCDN_P] = POS_INF_EXP;
+    }
+
+    void                makeNAN()
+    {
+        _init();
+        _d[BCDN_P] = NAN_EXP;
+    }
+
+    static bool         lt(const BCDN_F* a, const BCDN_F* b)
+    {
+        /* true iff a < b */
+        return bcd_cmp(a->_d, b->_d, BCDN_P, BCDN_P) < 0;
+    }
+
+    static bool         le(const BCDN_F* a, const BCDN_F* b)
+    {
+        /* true iff a <= b */
+        return bcd_cmp(a->_d, b->_d, BCDN_P, BCDN_P) <= 0;
+    }
+
+    static bool         gt(const BCDN_F* a, const BCDN_F* b)
+    {
+        /* true iff a > b */
+        return bcd_cmp(a->_d, b->_d, BCDN_P, BCDN_P) > 0;
+    }
+
+    static bool         ge(const BCDN_F* a, const BCDN_F* b)
+    {
+        /* true iff a >= b */
+        return bcd_cmp(a->_d, b->_d, BCDN_P, BCDN_P) >= 0;
+    }
+
+    static bool         equal(const BCDN_F* a, const BCDN_F* b)
+    {
+        return bcd_cmp(a->_d, b->_d, BCDN_P, BCDN_P) == 0;
+    }
+
+    static int4         ifloor(const BCDN_F* x) 
+    {
+        BCDN_F a;
+        floor(x, &a);
+        return a.asInt();
+    }
+
+    static int4         itrunc(const BCDN_F* x) 
+    {
+        BCDN_F a;
+        trunc(x, &a);
+        return a.asInt();
+    }
+
+    static bool         floor(const BCDN_F* a, BCDN_F* c) 
+    {
+        *c = *a;
+        bcd_floor(c->_d, BCDN_P);
+        return true;
+    }
+
+    static bool         trunc(const BCDN_F* a, BCDN_F* c)
+    {
+        /* truncate towards zero.
+         * trunc(2.1) = 2.
+         * trunc(-2.1) = -2
+         */
+        *c = *a;
+        int e = c->exp();
+        int i;
+        for (i = BCDN_P-1; i >= 0; --i) 
+            if (i >= e) c->_d[i] = 0;
+        return true;
+    }
+
+    void                _init() 
+    {
+        for (int i = 0; i <= BCDN_P; ++i) _d[i] = 0;
+    }
+
+    int                 _round25() { return bcd_round25(_d, BCDN_P); }
+    void                _fromUInt(uint4 v) { bcd_fromUInt(_d, BCDN_P, v); }
+
+    static void         epsilon(int n, BCDN_F* v)
+    {
+        // generate 10^-n, 
+        int m = BCDDecade[(n-1) & 3];
+        v->ldexp(m, -(n>>2));
+    }
+
+    int4                asInt() const
+    {
+        // if we fit in an int, return it otherwise 0
+        int ea = exp();
+        int4 v = 0;
+        int i = 0;
+        while (i < ea && i < BCDN_P) 
+        {
+            if (v > 214748L) return 0; // too large, bail out.
+            v*= BASE;
+            v += _d[i];
+            ++i;
+        }
+        if (neg()) v = -v;
+        return v;
+    }
+
+#undef BCDN_F
+#undef BCDN_DATA
+#undef BCDN_P
@@ -29,142 +29,10 @@
 
 struct BCDh
 {
-
-    // Constructors
-    BCDh() {}
-    BCDh(int4 v) : _v(v) {}
-    BCDh(uint4 v) : _v(v) {}
-
-    BCDh(const BCDFloatDataH& bf) : _v(bf) {}
-    BCDh(const BCDFloatData& bf) : _v(bf) {}
-    BCDh(const BCD& b) : _v(b._v) {}
-
-    int                 exponent() const { return _v.exp(); }
-    void                setExponent(int v) { _v.exp(v); }
-    int                 digit(int n) const { return _v._d[n]; }
-    void                digit(int n, int v)  { _v._d[n] = v; }
-    BCD                 asBCD() const
-    {
-        BCD v;
-        _v.asBCD(&v._v);
-        return v;
-    }
-
-    // Arithmetic
-    friend BCDh          operator+(const BCDh& a, const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::add(&a._v, &b._v, &c._v);
-        return c;
-    }
-    friend BCDh          operator-(const BCDh& a, const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::sub(&a._v, &b._v, &c._v);
-        return c;
-    }
-    friend BCDh          operator*(const BCDh& a, const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::mul(&a._v, &b._v, &c._v);
-        return c;
-    }
-    friend BCDh          operator/(const BCDh& a, const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::div(&a._v, &b._v, &c._v);
-        return c;
-    }
-    void                operator+=(const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::add(&_v, &b._v, &c._v);
-        _v = c._v;
-    }
-    void                operator-=(const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::sub(&_v, &b._v, &c._v);
-        _v = c._v;
-    }
-    void                operator*=(const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::mul(&_v, &b._v, &c._v);
-        _v = c._v;
-    }
-    void                operator/=(const BCDh& b)
-    {
-        BCDh c;
-        BCDFloatH::div(&_v, &b._v, &c._v);
-        _v = c._v;
-    }
-    BCDh                 operator-() const
-    {
-        BCDh c(*this);
-        c.negate();
-        return c;
-    }
-    void                operator++() { *this += 1; }
-    void                operator--() { *this -= 1; }
-
-
-    static BCDh          epsilon(int n)
-    {
-        BCDh v;
-        BCDFloatH::epsilon(n, &v._v);
-        return v;
-    }
-
-    friend int4         itrunc(const BCDh& a)
-                        { return BCDFloatH::itrunc(&a._v); }
-    friend BCDh         trunc(const BCDh& a)
-    {
-        /* truncate towards zero.
-         * trunc(2.1) = 2.
-         * trunc(-2.1) = -2
-         */
-        if (a.isSpecial()) return a;
-        BCDh t;
-        BCDFloatH::trunc(&a._v, &t._v);
-        return t;
-    }
-
-    friend BCDh          fabs(const BCDh& a) { return (a.isNeg()) ? -a : a; }
-    friend BCDh          frac(const BCDh& a)
-    {
-        if (a.isSpecial()) return a;
-        return a - trunc(a);
-    }
-
-    bool                isZero() const { return _v.isZero(); }
-    bool                isNeg() const { return _v.neg(); }
-    bool                isSpecial() const
-                                { return _v.isSpecial(); }
-    bool                isInf() const
-                                { return  _v.isInf(); }
-    bool                isNan() const
-                                { return _v.isNan(); }
-    bool                isInteger() const { return _v.isInteger(); }
-
-    void                negate() { _v.negate(); }
-
-
-    // Comparison
-    friend bool         operator==(const BCDh& a, const BCDh& b)
-                        { return BCDFloatH::equal(&a._v, &b._v); }
-    friend bool         operator!=(const BCDh& a, const BCDh& b)
-                        { return !BCDFloatH::equal(&a._v, &b._v); }
-    friend bool         operator<(const BCDh& a, const BCDh& b)
-                        { return BCDFloatH::lt(&a._v, &b._v); }
-    friend bool         operator<=(const BCDh& a, const BCDh& b)
-                        { return BCDFloatH::le(&a._v, &b._v); }
-    friend bool         operator>(const BCDh& a, const BCDh& b)
-                        { return BCDFloatH::gt(&a._v, &b._v); }
-    friend bool         operator>=(const BCDh& a, const BCDh& b)
-                        { return BCDFloatH::ge(&a._v, &b._v); }
-
-    BCDFloatH            _v;
+#define BCDN_W          BCDh
+#define BCDN_F          BCDFloatH
+#define BCDN_DATA       BCDFloatDataH
+#include "bcdn.h"
 };
 
 inline bool operator==(const BCDFloatDataH& a, const BCDFloatDataH& b)
@@ -71,6 +71,7 @@ typedef BCD BCD2;
 #define BCD_CONST_ROOTPI  (BCD_CONST_ONEP4+1)
 #define BCD_CONST_BCDMIN  (BCD_CONST_ROOTPI+1)
 #define BCD_CONST_ROOT2   (BCD_CONST_BCDMIN+1)
+#define BCD_CONST_EXPPOLY (BCD_CONST_ROOT2+1)
 
 namespace bcdmath
 {
@@ -85,6 +86,20 @@ typedef unsigned short Dig[P+1];
     memcpy(&_bcd._v, constTable + (_c), sizeof(BCDFloat));
 #endif
 
+#if defined(ARDUINO) || defined(BCD_CONST_COPY)
+/* copy the constant out. progmem must be, a host build can ask for
+ * it to time the difference.
+ */
+#define CONST_REF(_bcd, _c)  \
+    BCD _bcd; GET_CONST(_bcd, _c)
+#else
+/* refer to a table constant in place. no copy is made, the table
+ * rows have the same layout as BCD.
+ */
+#define CONST_REF(_bcd, _c)  \
+    const BCD& _bcd = *(const BCD*)(constTable + (_c))
+#endif
+
 static const Dig constTable[] PROGMEM = 
 {
     { 3, 1415, 9265, 3589, 7932, 3846, 2643, 1 }, // pi
@@ -221,12 +236,27 @@ static const Dig constTable[] PROGMEM =
     { 1, 7724, 5385, 905, 5160, 2729, 8167, 1 },  // sqrt(PI)
     { 10, 0, 0, 0, 0, 0, 0, 5693 }, // BCD MIN = 1e-9999
     { 1, 4142, 1356, 2373, 950, 4880, 1689, 1 }, // sqrt(2)
+
+    // exp(x) polynomial, 1/k! for k = 2..12
+    { 5000, 0, 0, 0, 0, 0, 0, 0 },
+    { 1666, 6666, 6666, 6666, 6666, 6666, 6667, 0 },
+    { 416, 6666, 6666, 6666, 6666, 6666, 6667, 0 },
+    { 83, 3333, 3333, 3333, 3333, 3333, 3333, 0 },
+    { 13, 8888, 8888, 8888, 8888, 8888, 8889, 0 },
+    { 1, 9841, 2698, 4126, 9841, 2698, 4127, 0 },
+    { 2480, 1587, 3015, 8730, 1587, 3015, 8730, (-1)&EXPMASK },
+    { 275, 5731, 9223, 9858, 9065, 2557, 3192, (-1)&EXPMASK },
+    { 27, 5573, 1922, 3985, 8906, 5255, 7319, (-1)&EXPMASK },
+    { 2, 5052, 1083, 8544, 1718, 7750, 5211, (-1)&EXPMASK },
+    { 2087, 6756, 9878, 6809, 8979, 2100, 9032, (-2)&EXPMASK },
 };
 
 #ifndef SMALL_INT
 
 #define BCD2_CONST_EXP1 0
 #define BCD2_CONST_LANCZOS 1
+#define BCD2_CONST_LN2 (BCD2_CONST_LANCZOS+13)
+#define BCD2_CONST_EXPTAB (BCD2_CONST_LN2+1)
 
 typedef unsigned short Dig2[P2+1];
 
@@ -304,21 +334,95 @@ static const Dig2 constTable2[] =
     { 277,957,5972,2463,9573,5873,7503,
       6522,6385,2612,8760,1919,8791,4529,9276,
       40956 },
+
+    // 0.6931,4718,0559,9453,0941,7232,1214,5817,6568,0755,0013,4360,2552,5412,068
+    { 6931, 4718, 559, 9453, 941, 7232, 1214,
+      5817,6568,755,13,4360,2552,5412,680,
+      0 }, // ln(2)
+
+    // exp(j/16), j = -11..11, for exp reduction
+    { 5028, 3157, 7970, 9409, 5968, 8636, 6114,
+      3762,5179,8828,4294,2801,994,3919,6152,
+      0 }, // exp(-11/16)
+    { 5352, 6142, 8518, 9902, 4195, 6622, 5080,
+      2204,6405,4335,4412,5036,218,9124,8900,
+      0 }, // exp(-10/16)
+    { 5697, 8282, 4730, 9230, 976, 6629, 6898,
+      2912,2815,8846,3847,4327,9959,7729,1009,
+      0 }, // exp(-9/16)
+    { 6065, 3065, 9712, 6334, 2360, 3799, 5349,
+      9118,453,4419,1813,5487,1869,5568,2892,
+      0 }, // exp(-8/16)
+    { 6456, 4852, 6427, 8920, 3734, 8355, 6800,
+      6103,1946,3609,3977,7279,5757,5451,7390,
+      0 }, // exp(-7/16)
+    { 6872, 8927, 8790, 9721, 9854, 5202, 3391,
+      4651,3590,4346,5202,3772,5210,6918,2657,
+      0 }, // exp(-6/16)
+    { 7316, 1562, 8946, 6417, 9115, 9559, 4204,
+      9140,2825,2812,8115,3219,8471,9284,4393,
+      0 }, // exp(-5/16)
+    { 7788, 78, 3071, 4048, 6824, 5170, 2669,
+      7832,647,2967,7229,426,1414,7424,1317,
+      0 }, // exp(-4/16)
+    { 8290, 2911, 8180, 4003, 4301, 4645, 5093,
+      4308,1862,4253,8840,9283,4511,3275,6991,
+      0 }, // exp(-3/16)
+    { 8824, 9690, 2584, 5954, 286, 4892, 1432,
+      2905,736,2220,482,4990,6507,4177,309,
+      0 }, // exp(-2/16)
+    { 9394, 1306, 2813, 4757, 8611, 9710, 8246,
+      2230,5084,5246,8089,549,4418,2200,9493,
+      0 }, // exp(-1/16)
+    { 1, 0, 0, 0, 0, 0, 0,
+      0,0,0,0,0,0,0,0,
+      1 }, // exp(0/16)
+    { 1, 644, 9445, 8917, 8594, 2956, 3390,
+      5946,4288,9673,1007,2544,3649,3533,152,
+      1 }, // exp(1/16)
+    { 1, 1331, 4845, 3066, 8263, 1682, 9007,
+      2278,1179,3872,5655,313,1745,1816,2591,
+      1 }, // exp(2/16)
+    { 1, 2062, 3024, 9420, 9807, 1065, 5586,
+      104,4643,3548,403,9364,6199,9703,8074,
+      1 }, // exp(3/16)
+    { 1, 2840, 2541, 6687, 7414, 8407, 3420,
+      5680,6243,6458,3362,8086,5281,4630,8922,
+      1 }, // exp(4/16)
+    { 1, 3668, 3794, 1173, 7963, 6283, 8756,
+      7727,2120,8672,1727,3329,4430,8111,7315,
+      1 }, // exp(5/16)
+    { 1, 4549, 9141, 4618, 2013, 3605, 3793,
+      6919,8751,8508,3468,4202,964,4156,8120,
+      1 }, // exp(6/16)
+    { 1, 5488, 3029, 8634, 1330, 9799, 8551,
+      9845,9549,2337,5583,366,2925,8105,7341,
+      1 }, // exp(7/16)
+    { 1, 6487, 2127, 700, 1281, 4684, 8650,
+      7878,1416,3571,6537,7610,710,1480,1158,
+      1 }, // exp(8/16)
+    { 1, 7550, 5465, 6960, 2985, 5724, 4047,
+      365,9896,7688,7382,3753,245,7485,3005,
+      1 }, // exp(9/16)
+    { 1, 8682, 4595, 7432, 2224, 650, 1835,
+      6201,8810,4453,1149,7228,3722,5540,8621,
+      1 }, // exp(10/16)
+    { 1, 9887, 3746, 9582, 2918, 3111, 7477,
+      3496,4692,5366,8482,5517,6410,5723,2628,
+      1 }, // exp(11/16)
 };
 #endif // !SMALL_INT
 
-BCD pi()
+BCDConst pi()
 {
-    BCD v;
-    GET_CONST(v, BCD_CONST_PI);
+    CONST_REF(v, BCD_CONST_PI);
     return v;
 }
 
 // 2pi
-BCD pi2()
+BCDConst pi2()
 {
-    BCD v;
-    GET_CONST(v, BCD_CONST_PI2);
+    CONST_REF(v, BCD_CONST_PI2);
     return v;
 }
 
@@ -330,7 +434,7 @@ static void horner(int cbase, BCD& x, int n, BCD& res)
     for (i = 0; i < n; ++i)
     {
         res *= x;
-        BCD c; --cn; GET_CONST(c, cn);
+        --cn; CONST_REF(c, cn);
         res += c;
     }
 }
@@ -456,7 +560,7 @@ BCD _gammaFactorialSlow(const BCD& z)
     int b[K+1];
     int tb;
     int i, j;
-    BCD half; GET_CONST(half, BCD_CONST_HALF);
+    CONST_REF(half, BCD_CONST_HALF);
 
     a[0] = 1;
     b[0] = -1;
@@ -538,15 +642,15 @@ void sincos(const BCD& v, BCD* sinv, BCD* cosv)
      * reduce to k*pi/32 + a, where a < pi/32. use a lookup table
      * for sin(k*pi/32) and cos(k*pi/32). require 8 entries for each.
      */
-    BCD piby32; GET_CONST(piby32, BCD_CONST_PIBY32);
+    CONST_REF(piby32, BCD_CONST_PIBY32);
     BCD a32 = a/piby32;
     k = ifloor(a32);
 
     if (k > 0) 
     {
         // subtract in two parts for accuracy.
-        BCD piby32a; GET_CONST(piby32a, BCD_CONST_PIBY32A);
-        BCD piby32b; GET_CONST(piby32b, BCD_CONST_PIBY32B);
+        CONST_REF(piby32a, BCD_CONST_PIBY32A);
+        CONST_REF(piby32b, BCD_CONST_PIBY32B);
         //a = a - k*piby32a - k*piby32b;
         BCD kf((unsigned int)k);
         a -= kf*piby32a;
@@ -619,12 +723,10 @@ void sincos(const BCD& v, BCD* sinv, BCD* cosv)
         sinPoly(a, sa);
         cosPoly(a, ca);
 
-        BCD sk;
-        BCD ck;
         if (k < 8) 
         {
-            GET_CONST(sk, BCD_CONST_SINTAB-1+k);
-            GET_CONST(ck, BCD_CONST_COSTAB-1+k);
+            CONST_REF(sk, BCD_CONST_SINTAB-1+k);
+            CONST_REF(ck, BCD_CONST_COSTAB-1+k);
             //sina = sk*ca + ck*sa;
             //cosa = ck*ca - sk*sa;
             
@@ -637,8 +739,8 @@ void sincos(const BCD& v, BCD* sinv, BCD* cosv)
         }
         else 
         {
-            GET_CONST(sk, BCD_CONST_SINTAB+15-k);
-            GET_CONST(ck, BCD_CONST_COSTAB+15-k);
+            CONST_REF(sk, BCD_CONST_SINTAB+15-k);
+            CONST_REF(ck, BCD_CONST_COSTAB+15-k);
             //sina = ck*ca + sk*sa;
             //cosa = sk*ca - ck*sa;
 
@@ -824,15 +926,17 @@ BCD powfmod(const BCD& a, int4 n, const BCD& fm)
 
 BCD exp(const BCD& v)
 {
-    /* write v = k*r + n*ln(2)
-     * where |k*r| < ln(2)
+    /* write v = n*ln(2) + r, |r| < ln(2), so that
      *
-     * let k be some power of 2, eg 64 so that
+     * exp(v) = exp(r)*2^n
      *
-     * exp(v) = exp(kr + nln(2)) = exp(kr)*2^n
-     *        = exp(r)^64 * 2^n
+     * r is then split as j/16 + s, |s| <= 1/32, so that
+     * exp(r) = exp(j/16)*exp(s). exp(j/16) comes from a table and
+     * exp(s)-1 from a degree 12 polynomial. the reduction and the
+     * scaling are done in double precision.
      *
-     * then r is small enough for Taylor series.
+     * SMALL_INT builds have no tables. they take r/64 instead and
+     * raise its series to the 64th power.
      */
     if (v.isSpecial()) 
     {
@@ -842,7 +946,7 @@ BCD exp(const BCD& v)
     
     if (v.isZero()) return 1;
 
-    BCD ln2; GET_CONST(ln2, BCD_CONST_LN2);
+    CONST_REF(ln2, BCD_CONST_LN2);
     BCD n = trunc(v/ln2);
 
     if (n > 33218)
@@ -857,6 +961,42 @@ BCD exp(const BCD& v)
     }
 
     int ni = itrunc(n);
+
+#ifndef SMALL_INT
+    /* reduce in double precision, v and n are exact */
+    BCD2 ln2d = *(const BCDFloat2*)(constTable2 + BCD2_CONST_LN2);
+    BCD2 r = BCD2(v) - BCD2(n)*ln2d;
+
+    /* |r| < ln(2), write r = j/16 + s where |s| <= 1/32, then
+     * exp(r) = exp(j/16)*exp(s) with exp(j/16) from the table
+     * in double precision and exp(s)-1 from a short polynomial.
+     */
+    CONST_REF(half, BCD_CONST_HALF);
+    int j = ifloor(r.asBCD()*16 + half);
+    BCD s = (r - BCD2(BCD(j)/16)).asBCD();
+
+    BCD ps;
+    horner(BCD_CONST_EXPPOLY, s, 11, ps);
+    BCD em1 = (ps*s + 1)*s;
+
+    BCD2 ej = *(const BCDFloat2*)(constTable2 + BCD2_CONST_EXPTAB + 11 + j);
+    BCD2 er = ej + ej*BCD2(em1);
+
+    /* scale by 2^n before the final rounding */
+    int4 m = ni < 0 ? -ni : ni;
+    BCD2 p2(1U);
+    BCD2 b(2U);
+    for (;;)
+    {
+        if (m & 1) p2 *= b;
+        m >>= 1;
+        if (!m) break;
+        b *= b;
+    }
+    if (ni < 0) er /= p2;
+    else er *= p2;
+    return er.asBCD();
+#else
     int k = 64;
     BCD r = (v - n*ln2)/k;
     
@@ -866,6 +1006,7 @@ BCD exp(const BCD& v)
     t1 = pow(er,k);
     er = t1 + t1/er*del*k;      // correction factor
     return er*pow(BCD(2), ni);
+#endif
 }
 
 static BCD _ln1p(const BCD& a)
@@ -993,7 +1134,7 @@ static BCD _log(const BCD& v, int4& p10, int4& p2, bool& neg)
 
     // find ck where ck = 1+k/64, k=1,2,..64 with |x-ck| <= 1/128
     BCD2 a21 = a2 - 1;
-    BCD half; GET_CONST(half, BCD_CONST_HALF);
+    CONST_REF(half, BCD_CONST_HALF);
     int k = ifloor(a21.asBCD()*64 + half); // round to nearest k
     
     // set r = 2*(a - ck)/(a + ck)
@@ -1006,21 +1147,21 @@ static BCD _log(const BCD& v, int4& p10, int4& p2, bool& neg)
     // ln(a) = ln(ck) + ln(a/ck);
     if (k)
     {
-        BCD lnck; GET_CONST(lnck, BCD_CONST_LOGCK + k -1);
+        CONST_REF(lnck, BCD_CONST_LOGCK + k -1);
         lna += lnck;
     }
     return lna;
 }
 
-BCD ln10constant()
+BCDConst ln10constant()
 {
-    BCD v; GET_CONST(v, BCD_CONST_LN10);
+    CONST_REF(v, BCD_CONST_LN10);
     return v;
 }
 
-BCD halfConstant()
+BCDConst halfConstant()
 {
-    BCD v; GET_CONST(v, BCD_CONST_HALF);
+    CONST_REF(v, BCD_CONST_HALF);
     return v;
 }
 
@@ -1032,8 +1173,8 @@ BCD log(const BCD& v)
     BCD lv = _log(v, p10, p2, neg);
     if (!lv.isSpecial())
     {
-        BCD ln10; GET_CONST(ln10, BCD_CONST_LN10);
-        BCD ln2; GET_CONST(ln2, BCD_CONST_LN2);
+        CONST_REF(ln10, BCD_CONST_LN10);
+        CONST_REF(ln2, BCD_CONST_LN2);
         lv += p10*ln10 + p2*ln2;
         if (neg) lv.negate();
     }
@@ -1048,8 +1189,8 @@ BCD log10(const BCD& v)
     BCD lv = _log(v, p10, p2, neg);
     if (!lv.isSpecial())
     {
-        BCD ln2Oln10; GET_CONST(ln2Oln10, BCD_CONST_LN2OLN10);
-        BCD ln10; GET_CONST(ln10, BCD_CONST_LN10);
+        CONST_REF(ln2Oln10, BCD_CONST_LN2OLN10);
+        CONST_REF(ln10, BCD_CONST_LN10);
         lv = lv/ln10 + p10 + p2*ln2Oln10;
         if (neg) lv.negate();
     }
@@ -1065,7 +1206,7 @@ BCD atan(const BCD& v)
     {
         if (v.isInf()) 
         {
-            BCD piby2; GET_CONST(piby2, BCD_CONST_PIBY2);
+            CONST_REF(piby2, BCD_CONST_PIBY2);
             if (neg) return (piby2*3)/2;
             return piby2;
         }
@@ -1088,7 +1229,7 @@ BCD atan(const BCD& v)
      * using
      *  tan(x/2) = tan(x)/(1+sqrt(1+tan(x)^2))
      */
-    BCD atanlim; GET_CONST(atanlim, BCD_CONST_ATANLIM);
+    CONST_REF(atanlim, BCD_CONST_ATANLIM);
     int doubles = 0;
     while (a > atanlim) 
     {
@@ -1125,7 +1266,7 @@ BCD atan(const BCD& v)
 
     if (invert) 
     {
-        BCD piby2; GET_CONST(piby2, BCD_CONST_PIBY2);
+        CONST_REF(piby2, BCD_CONST_PIBY2);
         s = piby2 - s;
     }
 
@@ -1159,7 +1300,7 @@ BCD atan2(const BCD& y, const BCD& x)
         r = atan(y/x);
         if (x.isNeg()) 
         {
-            BCD pi; GET_CONST(pi, BCD_CONST_PI);
+            CONST_REF(pi, BCD_CONST_PI);
             if (y.isNeg()) 
                 r = r - pi;
             else 
@@ -1476,7 +1617,7 @@ static const unsigned short pi2dp[] = {
 
 BCD modtwopi(const BCD& a)
 {
-    BCD pi2; GET_CONST(pi2, BCD_CONST_PI2);
+    CONST_REF(pi2, BCD_CONST_PI2);
     if (a < pi2) return a;
 
     unsigned short xd[2*P+1];
@@ -1626,7 +1767,7 @@ BCD fmod(const BCD& a, const BCD& b)
     {
 	// Numerator and denominator are both integral;
 	// in this case we force the result to be integral as well.
-	BCD half; GET_CONST(half, BCD_CONST_HALF);
+	CONST_REF(half, BCD_CONST_HALF);
 	if (c < 0)
 	    c = trunc(c - half);
 	else
@@ -1651,7 +1792,7 @@ BCD ln1p(const BCD& a)
     /* if x > 0.01, then the usual log calculation will give correct
      * results.
      */
-    BCD pointzeroone; GET_CONST(pointzeroone, BCD_CONST_HUNDREDTH);
+    CONST_REF(pointzeroone, BCD_CONST_HUNDREDTH);
     if (fabs(a) > pointzeroone) return log(1+a);
 
     /* otherwise use a series that converges for small arguments */
@@ -1693,7 +1834,7 @@ static void _gammaFactorialAux(const BCD& z,
     s = s2.asBCD();
     s *= 2;
 
-    BCD half; GET_CONST(half, BCD_CONST_HALF);
+    CONST_REF(half, BCD_CONST_HALF);
     t1 = z + half;
     t2 = t1 + GG;
 }
@@ -1742,7 +1883,7 @@ BCD gammaFactorial(const BCD& c)
     {
         /* use reflection formula */
         BCD z1 = -c;
-        BCD pi; GET_CONST(pi, BCD_CONST_PI);
+        CONST_REF(pi, BCD_CONST_PI);
         BCD z2 = z1*pi;
         return z2/sin(z2)/_gammaFactorial(z1);
     }
@@ -1770,7 +1911,7 @@ BCD gammaln(const BCD& z)
     {
         /* use reflection formula */
         BCD z1 = -c;
-        BCD pi; GET_CONST(pi, BCD_CONST_PI);
+        CONST_REF(pi, BCD_CONST_PI);
         BCD z2 = z1*pi;
         z2 /= sin(z2);
 
@@ -1797,7 +1938,7 @@ BCD expm1(const BCD& a)
     /* if |x| > 0.01, then the usual calculation will give correct
      * results.
      */
-    BCD pointzeroone; GET_CONST(pointzeroone, BCD_CONST_HUNDREDTH);
+    CONST_REF(pointzeroone, BCD_CONST_HUNDREDTH);
     if (fabs(a) >= pointzeroone)
         return exp(a)-1;
 
@@ -1892,8 +2033,8 @@ BCD erfNonNeg(const BCD& x)
 
     x2 = x*x;
 
-    BCD onep4; GET_CONST(onep4, BCD_CONST_ONEP4);
-    BCD rootpi; GET_CONST(rootpi, BCD_CONST_ROOTPI);
+    CONST_REF(onep4, BCD_CONST_ONEP4);
+    CONST_REF(rootpi, BCD_CONST_ROOTPI);
     if (x < onep4)
     {
         BCD s = x;
@@ -1928,8 +2069,8 @@ BCD erfNonNeg(const BCD& x)
     else 
     {
         BCD an, b, c, d, del, h;
-        BCD half; GET_CONST(half, BCD_CONST_HALF);
-        BCD min; GET_CONST(min, BCD_CONST_BCDMIN);
+        CONST_REF(half, BCD_CONST_HALF);
+        CONST_REF(min, BCD_CONST_BCDMIN);
 
         b = x2 + half;
         c = 1/min;
@@ -1977,8 +2118,8 @@ BCD erf(const BCD& v)
 
 BCD normalProbability(const BCD& v)
 {
-    BCD root2; GET_CONST(root2, BCD_CONST_ROOT2);
-    BCD half; GET_CONST(half, BCD_CONST_HALF);
+    CONST_REF(root2, BCD_CONST_ROOT2);
+    CONST_REF(half, BCD_CONST_HALF);
     return (erf(v/root2) + 1)*half;
 }
 
@@ -29,10 +29,16 @@
 namespace bcdmath
 {
 
-BCD pi();
-BCD pi2(); // 2pi
-BCD ln10constant();
-BCD halfConstant();
+#if defined(ARDUINO) || defined(BCD_CONST_COPY)
+typedef BCD BCDConst;  // constants are copied out of progmem
+#else
+typedef const BCD& BCDConst; // constants are referenced in place
+#endif
+
+BCDConst pi();
+BCDConst pi2(); // 2pi
+BCDConst ln10constant();
+BCDConst halfConstant();
 BCD sin(const BCD&);
 BCD cos(const BCD&);
 BCD tan(const BCD&);
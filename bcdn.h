@@ -0,0 +1,215 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ * 
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and 
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* body of a BCD value wrapper around the float struct made with
+ * "bcdfloatn.h". include inside the struct with these defined,
+ *
+ * BCDN_W       name of the wrapper
+ * BCDN_F       name of the float struct it holds
+ * BCDN_DATA    data base of the float struct
+ *
+ * no include guard, deliberately. the names are undefined at the end.
+ */
+
+    // Constructors
+    BCDN_W() {}
+    BCDN_W(int4 v) : _v(v) {}
+    BCDN_W(uint4 v) : _v(v) {}
+
+    BCDN_W(const BCDN_DATA& bf) : _v(bf) {}
+
+    BCDN_W(const BCDFloatData& bf) : _v(bf) {}
+    BCDN_W(const BCD& b) : _v(b._v) {}
+
+    int                 exponent() const { return _v.exp(); }
+    void                setExponent(int v) { _v.exp(v); }
+    int                 digit(int n) const { return _v._d[n]; }
+    void                digit(int n, int v)  { _v._d[n] = v; }
+    BCD                 asBCD() const
+    {
+        BCD v;
+        _v.asBCD(&v._v);
+        return v;
+    }
+
+    // Arithmetic
+    friend BCDN_W        operator+(const BCDN_W& a, const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::add(&a._v, &b._v, &c._v);
+        return c;
+    }
+    friend BCDN_W        operator-(const BCDN_W& a, const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::sub(&a._v, &b._v, &c._v);
+        return c;
+    }
+    friend BCDN_W        operator*(const BCDN_W& a, const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::mul(&a._v, &b._v, &c._v);
+        return c;
+    }
+    friend BCDN_W        operator/(const BCDN_W& a, const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::div(&a._v, &b._v, &c._v);
+        return c;
+    }
+    void                operator+=(const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::add(&_v, &b._v, &c._v);
+        _v = c._v;
+    }
+    void                operator-=(const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::sub(&_v, &b._v, &c._v);
+        _v = c._v;
+    }
+    void                operator*=(const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::mul(&_v, &b._v, &c._v);
+        _v = c._v;
+    }
+    void                operator/=(const BCDN_W& b)
+    {
+        BCDN_W c;
+        BCDN_F::div(&_v, &b._v, &c._v);
+        _v = c._v;
+    }
+    BCDN_W               operator-() const
+    {
+        BCDN_W c(*this);
+        c.negate();
+        return c;
+    }
+    void                operator++() { *this += 1; }
+    void                operator--() { *this -= 1; }
+
+    friend int4         ifloor(const BCDN_W& a)
+                        { return BCDN_F::ifloor(&a._v); }
+    friend int4         itrunc(const BCDN_W& a)
+                        { return BCDN_F::itrunc(&a._v); }
+    friend BCDN_W        floor(const BCDN_W& a)
+    {
+        /* floor, largest integer <= a.
+         * eg floor(2.1) = 2.
+         *    floor(-2.1) = -3.
+         */
+        BCDN_W t;
+        if (a.isSpecial()) return a;
+        BCDN_F::floor(&a._v, &t._v);
+        return t;
+    }
+
+    friend BCDN_W        trunc(const BCDN_W& a)
+    {
+        /* truncate towards zero.
+         * trunc(2.1) = 2.
+         * trunc(-2.1) = -2
+         */
+        if (a.isSpecial()) return a;
+        BCDN_W t;
+        BCDN_F::trunc(&a._v, &t._v);
+        return t;
+    }
+
+    friend BCDN_W        fabs(const BCDN_W& a) { return (a.isNeg()) ? -a : a; }
+    friend BCDN_W        frac(const BCDN_W& a)
+    {
+        if (a.isSpecial()) return a;
+        return a - trunc(a);
+    }
+    static BCDN_W        epsilon(int n)
+    {
+        BCDN_W v;
+        BCDN_F::epsilon(n, &v._v);
+        return v;
+    }
+
+    bool                isZero() const { return _v.isZero(); }
+    bool                isNeg() const { return _v.neg(); }
+    bool                isSpecial() const
+                                { return _v.isSpecial(); }
+    bool                isInf() const
+                                { return  _v.isInf(); }
+    bool                isNan() const
+                                { return _v.isNan(); }
+    bool                isInteger() const { return _v.isInteger(); }
+
+    void                negate() { _v.negate(); }
+
+    void                makeInf() { _v.makeInf(); }
+
+
+    // Comparison
+    friend bool         operator==(const BCDN_W& a, const BCDN_W& b)
+                        { return BCDN_F::equal(&a._v, &b._v); }
+    friend bool         operator!=(const BCDN_W& a, const BCDN_W& b)
+                        { return !BCDN_F::equal(&a._v, &b._v); }
+    friend bool         operator<(const BCDN_W& a, const BCDN_W& b)
+                        { return BCDN_F::lt(&a._v, &b._v); }
+    friend bool         operator<=(const BCDN_W& a, const BCDN_W& b)
+                        { return BCDN_F::le(&a._v, &b._v); }
+    friend bool         operator>(const BCDN_W& a, const BCDN_W& b)
+                        { return BCDN_F::gt(&a._v, &b._v); }
+    friend bool         operator>=(const BCDN_W& a, const BCDN_W& b)
+                        { return BCDN_F::ge(&a._v, &b._v); }
+
+    friend BCDN_W pow(const BCDN_W& a, int4 n)
+    {
+        int4 m;
+        if (n == 0) return 1;
+        m = (n < 0) ? -n : n;
+
+        BCDN_W s;
+        if (m > 1) 
+        {
+            BCDN_W r = a;
+            s = 1;
+            /* Use binary exponentiation */
+            for (;;) 
+            {
+                if (m & 1) s *= r;
+                m >>= 1;
+                if (!m) break;
+                r *= r;
+            }
+        } else { s = a; }
+
+        /* Compute the reciprocal if n is negative. */
+        if (n < 0) 
+            return 1/s;
+
+        return s;
+    }
+
+    BCDN_F              _v;
+
+#undef BCDN_W
+#undef BCDN_F
+#undef BCDN_DATA
@@ -0,0 +1,924 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ * 
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and 
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+#pragma warning (disable : 4244) // int -> short
+
+#include "bcdv.h"
+#include "bcdmath.h"
+
+/* working precision for new values, in 4decs. start as BCD2 */
+int BCDV::_pnContext = 2*P+1;
+
+static void bcdv_setexp(unsigned short* d, int pn, int e, int neg)
+{
+    // put back exponent & sign with range check
+    if (e > EXPLIMIT)
+    {
+        CLEAR(d, pn);
+        d[pn] = POS_INF_EXP;
+    }
+    else if (e <= -EXPLIMIT)
+    {
+        // underflow
+        CLEAR(d, pn+1);
+        return;
+    }
+    else SET_EXP(d, pn, e);
+    if (neg) SET_NEG_BIT(d, pn);
+}
+
+static void bcdv_fit(const unsigned short* s, int ps,
+                     unsigned short* d, int pd)
+{
+    // copy `s' of size `ps' into `d' of size `pd', rounding if shorter
+    if (pd >= ps || GET_SPECIAL(s, ps) || GET_ZERO_NORM(s, ps))
+    {
+        int n = ps < pd ? ps : pd;
+        COPY(d, s, n);
+        CLEAR(d + n, pd - n);
+        d[pd] = s[ps];
+    }
+    else
+    {
+        // copy the next digit too, for rounding
+        COPY(d, s, pd+1);
+        int e = GET_EXP(s, ps);
+        if (bcd_round(d, pd)) ++e;
+        bcdv_setexp(d, pd, e, GET_NEG_BIT(s, ps));
+    }
+}
+
+static bool bcdv_negligible(const BCDV& t, const BCDV& s)
+{
+    // is `t' too small to change `s'
+    return t.isZero() || s.exponent() - t.exponent() > s.size();
+}
+
+void BCDV::_alloc(int pn)
+{
+    _pn = pn;
+    _d = new unsigned short[pn+1];
+    CLEAR(_d, pn+1);
+}
+
+BCDV::BCDV(int4 v)
+{
+    _alloc(_pnContext);
+    if (v)
+    {
+        bool neg = v < 0;
+        if (neg) v = -v;
+        bcd_fromUInt(_d, _pn, (uint4)v);
+        if (neg) negate();
+    }
+}
+
+BCDV::BCDV(const BCD& v)
+{
+    _alloc(_pnContext);
+    bcdv_fit(v._v._d, P, _d, _pn);
+}
+
+BCDV::BCDV(const char* s)
+{
+    _alloc(_pnContext);
+    bcd_fromString(_d, _pn, s);
+}
+
+BCDV::BCDV(const BCDV& v)
+{
+    _alloc(v._pn);
+    COPY(_d, v._d, _pn+1);
+}
+
+BCDV& BCDV::operator=(const BCDV& v)
+{
+    if (this != &v)
+    {
+        if (_pn != v._pn)
+        {
+            delete [] _d;
+            _alloc(v._pn);
+        }
+        COPY(_d, v._d, _pn+1);
+    }
+    return *this;
+}
+
+int BCDV::setPrecision(int pn)
+{
+    int old = _pnContext;
+    if (pn < 2) pn = 2;
+    _pnContext = pn;
+    return old;
+}
+
+int BCDV::setDigits(int n)
+{
+    // enough 4decs for `n' digits, see DDIGITS
+    if (n > BCDV_MAX_DIGITS) n = BCDV_MAX_DIGITS;
+    int old = digits();
+    setPrecision((n + 6) >> 2);
+    return old;
+}
+
+BCD BCDV::asBCD() const
+{
+    BCD v;
+    bcdv_fit(_d, _pn, v._v._d, P);
+    return v;
+}
+
+void BCDV::asString(char* buf) const
+{
+    unsigned short* tmp = new unsigned short[_pn+1];
+    bcd_asString(_d, _pn, tmp, buf, BCDFloat::format_normal, DDIGITS(_pn));
+    delete [] tmp;
+}
+
+bool BCDV::isInteger() const
+{
+    if (isZero()) return true;
+    if (isSpecial()) return false;
+
+    int e = exponent();
+    int i;
+    for (i = _pn-1; i >= 0; --i) 
+        if (_d[i]) return e > i;
+    return false;
+}
+
+void BCDV::makeNAN()
+{
+    CLEAR(_d, _pn);
+    _d[_pn] = NAN_EXP;
+}
+
+void BCDV::makeInf()
+{
+    CLEAR(_d, _pn);
+    _d[_pn] = POS_INF_EXP;
+}
+
+void BCDV::resize(int pn)
+{
+    if (pn != _pn)
+    {
+        unsigned short* d = _d;
+        int ps = _pn;
+        _alloc(pn);
+        bcdv_fit(d, ps, _d, pn);
+        delete [] d;
+    }
+}
+
+void BCDV::mulInt(uint4 k)
+{
+    if (isSpecial() || isZero()) return;
+
+    int e = exponent();
+    int neg = GET_NEG_BIT(_d, _pn);
+    uint4 ca = 0;
+    uint4 v;
+    int rd = 0;
+    int i;
+
+    for (i = _pn-1; i >= 0; --i)
+    {
+        v = _d[i]*k + ca;
+        ca = v / BASE;
+        _d[i] = v - ca*BASE;
+    }
+
+    while (ca)
+    {
+        // carry out, shift down keeping the last digit for rounding
+        rd = _d[_pn-1];
+        for (i = _pn-1; i > 0; --i) _d[i] = _d[i-1];
+        v = ca;
+        ca = v / BASE;
+        _d[0] = v - ca*BASE;
+        ++e;
+    }
+
+    _d[_pn] = rd;
+    if (bcd_round(_d, _pn)) ++e;
+    bcdv_setexp(_d, _pn, e, neg);
+}
+
+void BCDV::divInt(uint4 k)
+{
+    if (isSpecial() || isZero()) return;
+
+    int e = exponent();
+    int neg = GET_NEG_BIT(_d, _pn);
+    uint4 r = 0;
+    uint4 v;
+    int i;
+
+    // short division, r*BASE + digit fits since k is small
+    for (i = 0; i < _pn; ++i)
+    {
+        v = r*BASE + _d[i];
+        _d[i] = v/k;
+        r = v - _d[i]*k;
+    }
+
+    while (!_d[0])
+    {
+        // leading zero, bring in another quotient digit
+        for (i = 0; i < _pn-1; ++i) _d[i] = _d[i+1];
+        v = r*BASE;
+        _d[_pn-1] = v/k;
+        r = v - _d[_pn-1]*k;
+        --e;
+    }
+
+    // next digit for rounding
+    _d[_pn] = (r*BASE)/k;
+    if (bcd_round(_d, _pn)) ++e;
+    bcdv_setexp(_d, _pn, e, neg);
+}
+
+static void bcdv_op(const BCDV& a, const BCDV& b, BCDV& c, int op)
+{
+    // c = a op b at the size of `c'.
+    // workspace holds `a' and `b' fitted to size plus kernel space.
+
+    int pn = c._pn;
+    unsigned short* t = new unsigned short[4*pn+8];
+    const unsigned short* ad = a._d;
+    const unsigned short* bd = b._d;
+
+    if (a._pn != pn)
+    {
+        bcdv_fit(a._d, a._pn, t, pn);
+        ad = t;
+    }
+    if (b._pn != pn)
+    {
+        bcdv_fit(b._d, b._pn, t + pn + 1, pn);
+        bd = t + pn + 1;
+    }
+
+    unsigned short* ws = t + 2*pn + 2;
+    switch (op)
+    {
+    case '+':
+        bcd_add(ad, bd, c._d, pn, pn);
+        break;
+    case '-':
+        bcd_sub(ad, bd, c._d, pn, pn);
+        break;
+    case '*':
+        bcd_mul(ad, bd, c._d, ws, pn, pn);
+        break;
+    case '/':
+        bcd_div(ad, bd, c._d, ws, pn, pn);
+        break;
+    }
+    delete [] t;
+}
+
+BCDV operator+(const BCDV& a, const BCDV& b)
+{
+    BCDV c;
+    bcdv_op(a, b, c, '+');
+    return c;
+}
+
+BCDV operator-(const BCDV& a, const BCDV& b)
+{
+    BCDV c;
+    bcdv_op(a, b, c, '-');
+    return c;
+}
+
+BCDV operator*(const BCDV& a, const BCDV& b)
+{
+    BCDV c;
+    bcdv_op(a, b, c, '*');
+    return c;
+}
+
+BCDV operator/(const BCDV& a, const BCDV& b)
+{
+    BCDV c;
+    bcdv_op(a, b, c, '/');
+    return c;
+}
+
+BCDV floor(const BCDV& a)
+{
+    BCDV c(a);
+    bcd_floor(c._d, c._pn);
+    return c;
+}
+
+int cmp(const BCDV& a, const BCDV& b)
+{
+    if (a.isNan() || b.isNan()) return 2;
+
+    int r;
+    if (a._pn == b._pn)
+        r = bcd_cmp(a._d, b._d, a._pn, b._pn);
+    else
+    {
+        // widen the shorter, which is exact
+        BCDV t;
+        if (a._pn < b._pn)
+        {
+            t.resize(b._pn);
+            bcdv_fit(a._d, a._pn, t._d, t._pn);
+            r = bcd_cmp(t._d, b._d, t._pn, b._pn);
+        }
+        else
+        {
+            t.resize(a._pn);
+            bcdv_fit(b._d, b._pn, t._d, t._pn);
+            r = bcd_cmp(a._d, t._d, a._pn, t._pn);
+        }
+    }
+    return r < 0 ? -1 : (r > 0);
+}
+
+/* constants. 
+ * calculated on demand and kept at the largest precision asked for.
+ */
+
+static BCDV bcdv_atanInv(uint4 m, bool hyp)
+{
+    /* atan(1/m) or atanh(1/m) by series,
+     * sum (+/-)1/((2k+1)*m^(2k+1))
+     * only short divisions are needed.
+     */
+    BCDV t(1);
+    t.divInt(m);
+    BCDV s(t);
+    uint4 m2 = m*m;
+    for (uint4 k = 1;; ++k)
+    {
+        t.divInt(m2);
+        BCDV u(t);
+        u.divInt(2*k+1);
+        if (bcdv_negligible(u, s)) break;
+        if ((k & 1) && !hyp) s -= u;
+        else s += u;
+    }
+    return s;
+}
+
+static BCDV* bcdv_const[3];
+
+static BCDV bcdv_constant(int c)
+{
+    BCDV* v = bcdv_const[c];
+    int pn = BCDV::precision();
+    if (!v || v->size() < pn)
+    {
+        int pn0 = BCDV::setPrecision(pn + 1);
+        BCDV r;
+        switch (c)
+        {
+        case 0:
+            // machin, pi = 16atan(1/5) - 4atan(1/239)
+            r = bcdv_atanInv(5, false);
+            r.mulInt(4);
+            r -= bcdv_atanInv(239, false);
+            r.mulInt(4);
+            break;
+        case 1:
+            // ln2 = 2atanh(1/3)
+            r = bcdv_atanInv(3, true);
+            r.mulInt(2);
+            break;
+        case 2:
+            // ln10 = 3ln2 + ln(5/4), ln(5/4) = 2atanh(1/9)
+            r = BCDV::ln2();
+            r.mulInt(3);
+            r += bcdv_atanInv(9, true) + bcdv_atanInv(9, true);
+            break;
+        }
+        BCDV::setPrecision(pn0);
+        delete v;
+        v = new BCDV(r);
+        bcdv_const[c] = v;
+    }
+    BCDV r(*v);
+    r.resize(pn);
+    return r;
+}
+
+BCDV BCDV::pi() { return bcdv_constant(0); }
+BCDV BCDV::ln2() { return bcdv_constant(1); }
+BCDV BCDV::ln10() { return bcdv_constant(2); }
+
+static void bcdv_scale2(BCDV& v, int s, bool up)
+{
+    // multiply or divide `v' by 2^s
+    while (s > 0)
+    {
+        int n = s > 12 ? 12 : s;
+        if (up) v.mulInt(1 << n);
+        else v.divInt(1 << n);
+        s -= n;
+    }
+}
+
+namespace bcdmath
+{
+
+/* series length and argument reduction are chosen from the precision.
+ * reducing the argument by 2^s before the series and undoing it after
+ * costs s steps but cuts the terms needed by about s*0.3 digits each.
+ * we balance the two with s ~ sqrt(digits). the guard digits cover the
+ * error growth of undoing the reduction.
+ */
+
+BCDV sqrt(const BCDV& x)
+{
+    BCDV r;
+    if (x.isNan() || x.isNeg())
+    {
+        r.makeNAN();
+        return r;
+    }
+    if (x.isZero() || x.isInf()) return x;
+
+    // start from the single precision root, then newton with
+    // the working precision doubling each time.
+    int pn0 = BCDV::precision();
+    int pnt = pn0 + 1;
+    int pp = P-1;
+    r = BCDV(::sqrt(x.asBCD()));
+    for (;;)
+    {
+        pp = 2*pp - 1;
+        if (pp > pnt) pp = pnt;
+        BCDV::setPrecision(pp);
+        r = r + x/r;
+        r.divInt(2);
+        if (pp == pnt) break;
+    }
+    BCDV::setPrecision(pn0);
+    r.resize(pn0);
+    return r;
+}
+
+BCDV exp(const BCDV& x)
+{
+    BCDV r;
+    if (x.isSpecial())
+    {
+        if (x.isNan()) r.makeNAN();
+        else if (!x.isNeg()) r.makeInf();
+        return r;
+    }
+    if (x.isZero()) return BCDV(1);
+
+    // beyond the exponent range
+    BCD xb = x.asBCD();
+    if (xb > BCD(23100))
+    {
+        r.makeInf();
+        return r;
+    }
+    if (xb < BCD(-23100)) return r;
+
+    int pn0 = BCDV::precision();
+    int d = BCDV::digits();
+    int s = isqrt(3*d);
+    int g = 2 + s/13;
+    if (x.exponent() > 0) g += x.exponent();
+    BCDV::setPrecision(pn0 + g);
+
+    // x = n*ln2 + r, |r| <= ln2/2
+    int4 n = ifloor(xb/bcdmath::log(BCD(2)) + BCD(1)/BCD(2));
+    r = x - BCDV(n)*BCDV::ln2();
+    bcdv_scale2(r, s, false);
+
+    // expm1 by taylor
+    BCDV t(r);
+    BCDV e1(r);
+    for (uint4 k = 2;; ++k)
+    {
+        t *= r;
+        t.divInt(k);
+        if (bcdv_negligible(t, e1)) break;
+        e1 += t;
+    }
+
+    // square back up in expm1 form, e1 = e1*(e1+2)
+    BCDV two(2);
+    int j;
+    for (j = 0; j < s; ++j) e1 *= e1 + two;
+
+    r = e1 + BCDV(1);
+
+    // times 2^n
+    int4 m = n < 0 ? -n : n;
+    if (m)
+    {
+        BCDV p(1);
+        BCDV b(2);
+        for (;;)
+        {
+            if (m & 1) p *= b;
+            m >>= 1;
+            if (!m) break;
+            b *= b;
+        }
+        if (n < 0) r /= p;
+        else r *= p;
+    }
+
+    BCDV::setPrecision(pn0);
+    r.resize(pn0);
+    return r;
+}
+
+BCDV log(const BCDV& x)
+{
+    BCDV r;
+    if (x.isNan() || x.isNeg())
+    {
+        r.makeNAN();
+        return r;
+    }
+    if (x.isInf()) return x;
+    if (x.isZero())
+    {
+        r.makeInf();
+        r.negate();
+        return r;
+    }
+
+    int pn0 = BCDV::precision();
+    int pnt = pn0 + 2;
+    BCDV::setPrecision(pnt);
+
+    BCDV one(1);
+    BCDV d = x - one;
+
+    if (d.exponent() <= -1)
+    {
+        // near 1 use log(x) = 2atanh((x-1)/(x+1))
+        BCDV t = d/(x + one);
+        BCDV t2 = t*t;
+        r = t;
+        for (uint4 k = 1;; ++k)
+        {
+            t *= t2;
+            BCDV u(t);
+            u.divInt(2*k+1);
+            if (bcdv_negligible(u, r)) break;
+            r += u;
+        }
+        r.mulInt(2);
+    }
+    else
+    {
+        /* halley on exp, y = y + 2(x - e^y)/(x + e^y).
+         * start from the single precision log and triple the 
+         * working precision each time.
+         */
+        int pp = P-1;
+        r = BCDV(bcdmath::log(x.asBCD()));
+        for (;;)
+        {
+            pp = 3*pp - 1;
+            if (pp > pnt) pp = pnt;
+            BCDV::setPrecision(pp);
+            BCDV ey = exp(r);
+            BCDV c = (x - ey)/(x + ey);
+            c.mulInt(2);
+            r += c;
+            if (pp == pnt) break;
+        }
+    }
+
+    BCDV::setPrecision(pn0);
+    r.resize(pn0);
+    return r;
+}
+
+void sincos(const BCDV& x, BCDV* sinv, BCDV* cosv)
+{
+    if (x.isSpecial())
+    {
+        if (sinv) sinv->makeNAN();
+        if (cosv) cosv->makeNAN();
+        return;
+    }
+
+    int pn0 = BCDV::precision();
+    int d = BCDV::digits();
+    int s = isqrt(2*d);
+    int g = 2 + s/13;
+
+    // large arguments need pi to more places
+    if (x.exponent() > 0) g += x.exponent();
+    BCDV::setPrecision(pn0 + g);
+
+    // x = k*pi/2 + r, |r| <= pi/4
+    BCDV hp = BCDV::pi();
+    hp.divInt(2);
+    BCDV half(1);
+    half.divInt(2);
+    BCDV k = floor(x/hp + half);
+
+    // k mod 4 from the units 4dec, BASE is a multiple of 4.
+    int q = 0;
+    if (!k.isZero())
+    {
+        int e = k.exponent();
+        if (e <= k.size()) q = k._d[e-1] & 3;
+        if (k.isNeg()) q = (4 - q) & 3;
+    }
+
+    BCDV r = x - k*hp;
+    bcdv_scale2(r, s, false);
+
+    // taylor for sin and 1-cos together
+    BCDV t(r);
+    BCDV sn(r);
+    BCDV u;
+    for (uint4 j = 2;; ++j)
+    {
+        t *= r;
+        t.divInt(j);
+        if (bcdv_negligible(t, sn)) break;
+
+        // signs go + + - - from j = 1
+        bool neg = ((j-1) & 2) != 0;
+        BCDV& acc = (j & 1) ? sn : u;
+        if (neg) acc -= t;
+        else acc += t;
+    }
+
+    // double back up, sin(2y) = 2sin(y)(1 - u), 1-cos(2y) = 2sin(y)^2
+    BCDV one(1);
+    int j;
+    for (j = 0; j < s; ++j)
+    {
+        BCDV c = one - u;
+        u = sn*sn;
+        u.mulInt(2);
+        sn *= c;
+        sn.mulInt(2);
+    }
+    BCDV cs = one - u;
+
+    BCDV::setPrecision(pn0);
+    sn.resize(pn0);
+    cs.resize(pn0);
+
+    switch (q)
+    {
+    case 1:
+        t = sn; sn = cs; cs = -t;
+        break;
+    case 2:
+        sn = -sn; cs = -cs;
+        break;
+    case 3:
+        t = sn; sn = -cs; cs = t;
+        break;
+    }
+    if (sinv) *sinv = sn;
+    if (cosv) *cosv = cs;
+}
+
+BCDV sin(const BCDV& x)
+{
+    BCDV s;
+    sincos(x, &s, 0);
+    return s;
+}
+
+BCDV cos(const BCDV& x)
+{
+    BCDV c;
+    sincos(x, 0, &c);
+    return c;
+}
+
+BCDV atan(const BCDV& x)
+{
+    BCDV r;
+    if (x.isNan())
+    {
+        r.makeNAN();
+        return r;
+    }
+    if (x.isZero()) return r;
+
+    int pn0 = BCDV::precision();
+
+    if (x.isInf())
+    {
+        r = BCDV::pi();
+        r.divInt(2);
+        if (x.isNeg()) r.negate();
+        return r;
+    }
+
+    int d = BCDV::digits();
+    int s = isqrt(d/3) + 1;
+    BCDV::setPrecision(pn0 + 2 + s/13);
+
+    BCDV one(1);
+    BCDV a = fabs(x);
+    bool inv = a > one;
+    if (inv) a = one/a;
+
+    // halve the angle, atan(a) = 2atan(a/(1 + sqrt(1 + a^2)))
+    int j;
+    for (j = 0; j < s; ++j)
+        a = a/(one + sqrt(one + a*a));
+
+    // taylor, a - a^3/3 + a^5/5 - ...
+    BCDV a2 = a*a;
+    BCDV t(a);
+    r = a;
+    for (uint4 k = 1;; ++k)
+    {
+        t *= a2;
+        BCDV u(t);
+        u.divInt(2*k+1);
+        if (bcdv_negligible(u, r)) break;
+        if (k & 1) r -= u;
+        else r += u;
+    }
+    bcdv_scale2(r, s, true);
+
+    if (inv)
+    {
+        BCDV hp = BCDV::pi();
+        hp.divInt(2);
+        r = hp - r;
+    }
+    if (x.isNeg()) r.negate();
+
+    BCDV::setPrecision(pn0);
+    r.resize(pn0);
+    return r;
+}
+
+/* spouge's approximation,
+ * gamma(z+1) = (z+a)^(z+1/2)*e^-(z+a)*(c0 + sum c(k)/(z+k), k=1..a-1)
+ * c0 = sqrt(2pi),
+ * c(k) = (-1)^(k-1)/(k-1)! * (a-k)^(k-1/2) * e^(a-k)
+ *
+ * the relative error is less than (2pi)^-(a+1/2), so `a' is 1.26 times
+ * the digits wanted. the sum cancels about 0.2*digits, which are
+ * carried as guard. the coefficients depend only on the precision and
+ * are kept for the next call.
+ */
+
+static BCDV*    spougeC;
+static int      spougeA;
+static int      spougePn;
+
+static void _spougeCoefficients(int a)
+{
+    int pn = BCDV::precision();
+    if (spougeC && spougeA == a && spougePn == pn) return;
+
+    delete [] spougeC;
+    spougeC = new BCDV[a];
+    spougeA = a;
+    spougePn = pn;
+
+    BCDV pi2 = BCDV::pi();
+    pi2.mulInt(2);
+    spougeC[0] = sqrt(pi2);
+
+    // e^(a-k), from k = a-1 down
+    BCDV e1 = exp(BCDV(1));
+    BCDV ek(e1);
+
+    int k;
+    for (k = a-1; k >= 1; --k)
+    {
+        // (a-k)^k/(k-1)! 
+        uint4 m = a - k;
+        BCDV t(1);
+        int j;
+        for (j = 1; j <= k; ++j)
+        {
+            t.mulInt(m);
+            if (j < k) t.divInt(j);
+        }
+        t = t*ek/sqrt(BCDV((int4)m));
+        if (!(k & 1)) t.negate();
+        spougeC[k] = t;
+        ek *= e1;
+    }
+}
+
+BCDV gammaFactorial(const BCDV& x)
+{
+    BCDV r;
+    if (x.isNan() || (x.isInf() && x.isNeg()))
+    {
+        r.makeNAN();
+        return r;
+    }
+    if (x.isInf()) return x;
+
+    int pn0 = BCDV::precision();
+
+    if (x.isInteger())
+    {
+        if (x.isNeg())
+        {
+            // pole
+            r.makeNAN();
+            return r;
+        }
+
+        // direct product, 3249! is the last in range
+        int4 n = ifloor(x.asBCD());
+        if (n > 3300)
+        {
+            r.makeInf();
+            return r;
+        }
+
+        BCDV::setPrecision(pn0 + 1);
+        r = BCDV(1);
+        for (int4 i = 2; i <= n; ++i) r.mulInt(i);
+        BCDV::setPrecision(pn0);
+        r.resize(pn0);
+        return r;
+    }
+
+    BCDV one(1);
+    if (x < -one)
+    {
+        // reflect, x! = pi/(sin(pi(x+1))*(-x-1)!)
+        BCDV::setPrecision(pn0 + 1);
+        BCDV z = x + one;
+        BCDV p = BCDV::pi();
+        r = p/(sin(p*z)*gammaFactorial(-z));
+        BCDV::setPrecision(pn0);
+        r.resize(pn0);
+        return r;
+    }
+
+    int d = BCDV::digits();
+    int a = (d*63)/50 + 2;
+    BCDV::setDigits(d + d/4 + 12);
+
+    _spougeCoefficients(a);
+
+    BCDV s(spougeC[0]);
+    int k;
+    for (k = 1; k < a; ++k) s += spougeC[k]/(x + BCDV((int4)k));
+
+    BCDV half(1);
+    half.divInt(2);
+    BCDV za = x + BCDV((int4)a);
+    r = exp((x + half)*log(za) - za)*s;
+
+    BCDV::setPrecision(pn0);
+    r.resize(pn0);
+    return r;
+}
+
+}; // namespace
+
+void finishBCDV()
+{
+    int i;
+    for (i = 0; i < 3; ++i)
+    {
+        delete bcdv_const[i];
+        bcdv_const[i] = 0;
+    }
+
+    delete [] bcdmath::spougeC;
+    bcdmath::spougeC = 0;
+    bcdmath::spougeA = 0;
+}
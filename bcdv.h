@@ -0,0 +1,164 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ * 
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and 
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+#ifndef __bcdv_h__
+#define __bcdv_h__
+
+#include "bcd.h"
+
+/* variable precision BCD.
+ *
+ * like BCD but the number of 4dec digits is chosen at runtime. new
+ * values take the current context precision, set by `setDigits', and
+ * arithmetic delivers its result at that precision, fitting the
+ * operands to it as required. this allows the math functions to raise
+ * the context for guard digits and fit the result back down at the end.
+ *
+ * the kernels are the same as for BCD, only the digit count differs.
+ */
+
+#define BCDV_MAX_DIGITS  1000
+
+/* the most digits a user can ask for. the functions raise the context
+ * for guard digits, gamma by the most at d + d/4 + 12, and all of that
+ * must fit under BCDV_MAX_DIGITS or the guard is silently lost.
+ */
+#define BCDV_USER_DIGITS 500
+
+#if BCDV_USER_DIGITS + BCDV_USER_DIGITS/4 + 12 > BCDV_MAX_DIGITS
+#error BCDV_USER_DIGITS leaves no room for guard digits
+#endif
+
+struct BCDV
+{
+    // Constructors
+    BCDV() { _alloc(_pnContext); }
+    explicit BCDV(int4 v);
+    explicit BCDV(const BCD& v);
+    BCDV(const char* s);
+    BCDV(const BCDV& v);
+    ~BCDV() { delete [] _d; }
+
+    BCDV&               operator=(const BCDV& v);
+
+    // context precision, in decimal digits. returns old value.
+    static int          setDigits(int n);
+    static int          digits() { return DDIGITS(_pnContext); }
+
+    // context precision in 4decs.
+    static int          setPrecision(int pn);
+    static int          precision() { return _pnContext; }
+
+    BCD                 asBCD() const;
+
+    // `buf' must hold digits()+16 characters
+    void                asString(char* buf) const;
+
+    int                 exponent() const { return GET_EXP(_d, _pn); }
+    int                 size() const { return _pn; }
+
+    bool                isZero() const { return IS_ZERO(_d, _pn); }
+    bool                isNeg() const { return IS_NEG(_d, _pn); }
+    bool                isSpecial() const { return GET_SPECIAL(_d, _pn) != 0; }
+    bool                isNan() const { return GET_NAN(_d, _pn) != 0; }
+    bool                isInf() const { return GET_INF(_d, _pn) != 0; }
+    bool                isInteger() const;
+
+    void                negate() { if (!isZero()) NEGATE_SIGN(_d, _pn); }
+    void                makeNAN();
+    void                makeInf();
+
+    // change to `pn' 4decs, rounding if shorter
+    void                resize(int pn);
+
+    // exact scaling by small integers, 0 < k < 200000
+    void                mulInt(uint4 k);
+    void                divInt(uint4 k);
+
+    // Arithmetic
+    friend BCDV         operator+(const BCDV& a, const BCDV& b);
+    friend BCDV         operator-(const BCDV& a, const BCDV& b);
+    friend BCDV         operator*(const BCDV& a, const BCDV& b);
+    friend BCDV         operator/(const BCDV& a, const BCDV& b);
+
+    void                operator+=(const BCDV& b) { *this = *this + b; }
+    void                operator-=(const BCDV& b) { *this = *this - b; }
+    void                operator*=(const BCDV& b) { *this = *this * b; }
+    void                operator/=(const BCDV& b) { *this = *this / b; }
+
+    BCDV                operator-() const
+    {
+        BCDV c(*this);
+        c.negate();
+        return c;
+    }
+
+    friend BCDV         fabs(const BCDV& a) { return a.isNeg() ? -a : a; }
+    friend BCDV         floor(const BCDV& a);
+
+    // Comparison. -1, 0 or 1, 2 if either is nan.
+    friend int          cmp(const BCDV& a, const BCDV& b);
+    friend bool         operator==(const BCDV& a, const BCDV& b)
+                        { return cmp(a, b) == 0; }
+    friend bool         operator!=(const BCDV& a, const BCDV& b)
+                        { return cmp(a, b) != 0; }
+    friend bool         operator<(const BCDV& a, const BCDV& b)
+                        { return cmp(a, b) < 0; }
+    friend bool         operator<=(const BCDV& a, const BCDV& b)
+                        { return cmp(a, b) <= 0; }
+    friend bool         operator>(const BCDV& a, const BCDV& b)
+                        { return cmp(a, b) == 1; }
+    friend bool         operator>=(const BCDV& a, const BCDV& b)
+                        { int c = cmp(a, b); return c >= 0 && c != 2; }
+
+    // constants at the context precision, cached.
+    static BCDV         pi();
+    static BCDV         ln2();
+    static BCDV         ln10();
+
+    void                _alloc(int pn);
+
+    unsigned short*     _d;
+    int                 _pn;
+
+    static int          _pnContext;
+};
+
+namespace bcdmath
+{
+
+BCDV sqrt(const BCDV&);
+BCDV exp(const BCDV&);
+BCDV log(const BCDV&);
+BCDV sin(const BCDV&);
+BCDV cos(const BCDV&);
+BCDV atan(const BCDV&);
+BCDV gammaFactorial(const BCDV&);
+void sincos(const BCDV& v, BCDV* sinv, BCDV* cosv);
+
+}; // namespace
+
+// free the cached constants, they are made again when next needed
+void finishBCDV();
+
+#endif // __bcdv_h__
@@ -0,0 +1,128 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ * 
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and 
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+#ifndef __bcdx_h__
+#define __bcdx_h__
+
+/* additional working precisions made from the shared struct bodies,
+ * "bcdfloatn.h" and "bcdn.h". named by nominal decimal digits, which
+ * is 4 per 4dec. the kernels handle up to MAX_P 4decs.
+ *
+ * the calculator itself does not use these, the host tools do.
+ */
+
+#include "bcd.h"
+
+#define P8 2
+
+struct BCDFloatData8
+{
+    unsigned short      _d[P8+1];
+};
+
+struct BCDFloat8: public BCDFloatData8
+{
+#define BCDN_F          BCDFloat8
+#define BCDN_DATA       BCDFloatData8
+#define BCDN_P          P8
+#include "bcdfloatn.h"
+};
+
+struct BCD8
+{
+#define BCDN_W          BCD8
+#define BCDN_F          BCDFloat8
+#define BCDN_DATA       BCDFloatData8
+#include "bcdn.h"
+};
+
+#define P16 4
+
+struct BCDFloatData16
+{
+    unsigned short      _d[P16+1];
+};
+
+struct BCDFloat16: public BCDFloatData16
+{
+#define BCDN_F          BCDFloat16
+#define BCDN_DATA       BCDFloatData16
+#define BCDN_P          P16
+#include "bcdfloatn.h"
+};
+
+struct BCD16
+{
+#define BCDN_W          BCD16
+#define BCDN_F          BCDFloat16
+#define BCDN_DATA       BCDFloatData16
+#include "bcdn.h"
+};
+
+#define P32 8
+
+struct BCDFloatData32
+{
+    unsigned short      _d[P32+1];
+};
+
+struct BCDFloat32: public BCDFloatData32
+{
+#define BCDN_F          BCDFloat32
+#define BCDN_DATA       BCDFloatData32
+#define BCDN_P          P32
+#include "bcdfloatn.h"
+};
+
+struct BCD32
+{
+#define BCDN_W          BCD32
+#define BCDN_F          BCDFloat32
+#define BCDN_DATA       BCDFloatData32
+#include "bcdn.h"
+};
+
+#define P64 16
+
+struct BCDFloatData64
+{
+    unsigned short      _d[P64+1];
+};
+
+struct BCDFloat64: public BCDFloatData64
+{
+#define BCDN_F          BCDFloat64
+#define BCDN_DATA       BCDFloatData64
+#define BCDN_P          P64
+#include "bcdfloatn.h"
+};
+
+struct BCD64
+{
+#define BCDN_W          BCD64
+#define BCDN_F          BCDFloat64
+#define BCDN_DATA       BCDFloatData64
+#include "bcdn.h"
+};
+
+#endif // __bcdx_h__
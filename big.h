@@ -202,6 +202,28 @@ struct BigInt
                          const BigInt& m)
     { return powerBigintMod(a._big, n, m._big); }
 
+    // montgomery residues, see BigMont
+    friend bool initMont(BigMont& mc, const BigInt& m)
+    { return initBigMont(&mc, m._big); }
+
+    friend Big* toMont(const BigInt& a, BigMont& mc)
+    { return toBigMont(&mc, a._big); }
+
+    friend Big* fromMont(const BigInt& a, BigMont& mc)
+    { return fromBigMont(&mc, a._big); }
+
+    friend Big* mulMont(const BigInt& a, const BigInt& b, BigMont& mc)
+    { return mulBigMont(&mc, a._big, b._big); }
+
+    friend Big* sqrMont(const BigInt& a, BigMont& mc)
+    { return mulBigMont(&mc, a._big, a._big); }
+
+    friend Big* powMont(const BigInt& a, const BigInt& n, BigMont& mc)
+    {
+        // residue of a^n
+        return powerBigMont(&mc, a._big, n._big);
+    }
+
     friend Big* subMod(const BigInt& a, const BigInt& b, const BigInt& n)
     {
         Big* v = subBig(a._big, b._big);
@@ -235,6 +257,20 @@ struct BigInt
         return _big ? bigAsUint(_big) : 0;
     }
 
+    unsigned int modUInt(unsigned int m) const
+    {
+        // remainder by a small divisor
+        return _big ? modBig(_big, m) : 0;
+    }
+
+    bool bit(unsigned int i) const
+    {
+        // bit i of |a|
+        unsigned int k = (i >> BASEBITSBITS) + 1;
+        return _big && k <= DIGITS(_big) &&
+            ((_big[k] >> (i & (BASEBITS-1))) & 1);
+    }
+
     BCD         asBCD() const
     {
         BCD nf(0);
@@ -46,6 +46,24 @@ bool isOddCompositeAux(CompState& st)
     // perform one test
     bool res = false;
 
+    if (st._mont.valid())
+    {
+        /* as below, but with residues */
+        BigInt v = powMont(BigInt(st._dn), st._s, st._mont);
+        if (v != st._one && v != st._mnm1)
+        {
+            unsigned int j;
+            bool hit = false;
+            for (j = 1; j < st._r; ++j)
+            {
+                v = sqrMont(v, st._mont);
+                if (v == st._mnm1) { hit = true; break; }
+            }
+            res = !hit;
+        }
+        return res;
+    }
+
     /* find a^s mod n */
     BigInt v = powMod(BigInt(st._dn), st._s, st._n);
     if (v != 1 && v != st._nm1)
@@ -63,9 +81,137 @@ bool isOddCompositeAux(CompState& st)
     return res;
 }
 
+static int _jacobi(unsigned int a, unsigned int m)
+{
+    // jacobi symbol (a/m), m odd
+    unsigned int r;
+    int t = 1;
+
+    a %= m;
+    while (a)
+    {
+        while (!(a & 1))
+        {
+            a >>= 1;
+            r = m & 7;
+            if (r == 3 || r == 5) t = -t;
+        }
+        r = a; a = m; m = r;
+        if ((a & 3) == 3 && (m & 3) == 3) t = -t;
+        a %= m;
+    }
+    return m == 1 ? t : 0;
+}
+
+static Big* _addMod(const BigInt& a, const BigInt& b, const BigInt& n)
+{
+    // a + b mod n, both in [0,n)
+    BigInt t = a + b;
+    if (t >= n) t -= n;
+    return t.give();
+}
+
+static Big* _halfMod(const BigInt& a, const BigInt& n)
+{
+    // a/2 mod n, n odd
+    if (a.isOdd()) return ((a + n) >> 1).give();
+    return (a >> 1).give();
+}
+
+static bool _isLucasComposite(CompState& st)
+{
+    // strong lucas test with selfridge's parameters, P = 1 and
+    // Q = (1-D)/4. works on the residues of CompState, which
+    // halving and small multiples carry over to unchanged.
+    // true, definitely composite.
+    // ASSUME n odd and much larger than D.
+
+    const BigInt& n = st._n;
+    BigMont& mc = st._mont;
+
+    // squares have no suitable D
+    BigInt k = sqrt(n);
+    if (k*k == n) return true;
+
+    // first of D = 5, -7, 9, -11 ... with (D/n) = -1.
+    // as D = 1 mod 4, (D/n) = (n/|D|)
+    int D = 5;
+    for (;;)
+    {
+        unsigned int a = D > 0 ? D : -D;
+        int j = _jacobi(n.modUInt(a), a);
+        if (j < 0) break;
+        if (!j) return true; // shares a factor with D
+        D = D > 0 ? -D - 2 : -D + 2;
+    }
+
+    // n + 1 = d.2^s
+    BigInt d = n + 1;
+    unsigned int s = 0;
+    while (d.isEven())
+    {
+        d >>= 1;
+        ++s;
+    }
+
+    // U(d), V(d) and Q^d from the top bit down
+    BigInt q = toMont(BigInt(mod(BigInt((1 - D)/4), n)), mc);
+    BigInt u = st._one;         // U(1)
+    BigInt v = st._one;         // V(1) = P
+    BigInt qk = q;              // Q^1
+    unsigned int i = log2(d);
+
+    while (i--)
+    {
+        // k -> 2k
+        u = mulMont(u, v, mc);
+        v = subMod(BigInt(sqrMont(v, mc)), BigInt(_addMod(qk, qk, n)), n);
+        qk = sqrMont(qk, mc);
+
+        if (d.bit(i))
+        {
+            // k -> k+1
+            BigInt du = mod(u*D, n);
+            u = _halfMod(BigInt(_addMod(u, v, n)), n);
+            v = _halfMod(BigInt(_addMod(du, v, n)), n);
+            qk = mulMont(qk, q, mc);
+        }
+    }
+
+    if (u == 0 || v == 0) return false;
+
+    // V(d.2^r), r < s
+    while (--s)
+    {
+        v = subMod(BigInt(sqrMont(v, mc)), BigInt(_addMod(qk, qk, n)), n);
+        if (v == 0) return false;
+        qk = sqrMont(qk, mc);
+    }
+    return true;
+}
+
+static int primeTestMode = PRIMETEST_BPSW;
+
+int setPrimeTest(int mode)
+{
+    // choose how isOddComposite tests, return the old mode
+    int old = primeTestMode;
+    primeTestMode = mode;
+    return old;
+}
+
 bool isOddComposite(const BigInt& n)
 {
     CompState st(n);
+
+    if (primeTestMode == PRIMETEST_BPSW && st._mont.valid() &&
+        log2(n) >= BPSW_MINBITS)
+    {
+        // baillie-psw, strong base 2 then strong lucas
+        st.next();
+        return isOddCompositeAux(st) || _isLucasComposite(st);
+    }
+
     st.setDefaultLimit();
 
     for (;;)
@@ -102,61 +248,6 @@ int isPrime(const BigInt& n)
     return !isComposite(n);
 }
 
-struct SmallPrimes
-{
-    // generate small, odd primes
-    SmallPrimes()
-    {
-        _p = 1;
-        _rp = 1;
-        _rp2 = 4;
-        _ai = 0;
-    }
-
-    unsigned int next()
-    {
-        // start after the number 7
-        static int add[] = {4, 2, 4, 2, 4, 6, 2, 6};
-
-        if (_p < 7)
-        {
-            // generate 3, 5, 7
-            _p += 2;
-        }
-        else
-        {
-        again:
-            // then > 7, not multiples of 2, 3, 5
-            _p += add[_ai++];
-            _ai &= 0x7;
-        }
-            
-        // adjust root
-        if (_p >= _rp2)
-        {
-            ++_rp;
-            _rp2 = _rp + 1;
-            _rp2 *= _rp2;
-        }
-
-        // now try small divisors up to sqroot
-        SmallDivs sd;
-        unsigned int d = 7;
-
-        while (d <= _rp)
-        {
-            if (_p % d == 0) goto again;
-            d = sd.next();
-        }
-        return _p;
-    }
-    
-    unsigned int        _ai;
-    unsigned int        _p;     // current prime
-    unsigned int        _rp;    // floor(root p)
-    unsigned int        _rp2;   // [floor(root p) + 1]^2
-};
-
 /// here define class needed for ECM
 struct ECurve
 {
@@ -256,8 +347,228 @@ struct EPoint
     ECurve&             _c;
 };
 
-bool Lenstra(const BigInt& n, BigInt& f, int ntrials)
+static unsigned int _curveSeed(unsigned int cc)
 {
+    // seed for curve `cc'. it depends on `cc' alone, so any
+    // subset of the curves can be run in any order and each
+    // curve is still the same curve.
+    unsigned int s = (cc + 1)*2654435761U;
+    s ^= s >> 16;
+    s *= 0x45d9f3bU;
+    s ^= s >> 16;
+    return s;
+}
+
+#ifndef ECM_B2
+#define ECM_B2          50      // stage 2 bound as a multiple of b1
+#endif
+
+#define ECM_D           210     // giant step, 2.3.5.7
+#define ECM_BABY        24      // odd j < D/2, prime to D
+
+static int _ecmStage2(const EPoint& q, unsigned int b1, unsigned int b2,
+                      BigInt& f)
+{
+    // stage 2, look for a single prime s in (b1, b2] with [s]q = 0
+    // mod some p|n. put s = mD -/+ j, then [mD]q = +/-[j]q mod p
+    // so p divides X(mD)Z(j) - X(j)Z(mD). these are multiplied
+    // together for all such s and tried with one gcd at the end.
+    // return as _ecmCurve.
+
+    const BigInt& n = q._c._n;
+    ECurve& c = q._c;
+    BigInt bx[ECM_BABY];
+    BigInt bz[ECM_BABY];
+    unsigned int bj[ECM_BABY];
+    unsigned int nb = 0;
+    unsigned int j;
+
+    // baby steps [j]q, by [j+2]q = [j]q + [2]q with difference [j-2]q
+    EPoint q2(c);
+    EPoint a(c);
+    EPoint b(c);
+    EPoint t(c);
+
+    twiceh(q, q2);
+    a = q;      // [-1]q, same x as q
+    b = q;
+    for (j = 1; j < ECM_D/2; j += 2)
+    {
+        if (j % 3 && j % 5 && j % 7)
+        {
+            bx[nb] = b._x;
+            bz[nb] = b._z;
+            bj[nb++] = j;
+        }
+        addh(b, q2, a, t);
+        a = b;
+        b = t;
+    }
+    if (!b.valid()) return -1;
+
+    // primes to sieve with. s is prime to D so start at 11.
+    unsigned int rt = 11;
+    while (rt*rt <= b2) ++rt;
+
+    unsigned int* ps = new unsigned int[rt/2 + 1];
+    unsigned int np = 0;
+    unsigned int p;
+    SmallPrimes sp;
+    while ((p = sp.next()) <= rt)
+        if (p > 7) ps[np++] = p;
+
+    // giant steps [mD]q, by [(m+1)D]q = [mD]q + [D]q with
+    // difference [(m-1)D]q
+    unsigned int m = b1/ECM_D;
+    if (m < 2) m = 2;
+
+    EPoint g(c);
+    EPoint u(c);
+    EPoint um(c);
+    mulnh(q, ECM_D, g);
+    mulnh(q, (m-1)*ECM_D, um);
+    mulnh(q, m*ECM_D, u);
+
+    bool comp[ECM_D + 1];
+    BigInt acc = 1;
+    int res = 0;
+
+    for (; m*ECM_D <= b2 + ECM_D/2; ++m)
+    {
+        if (!u.valid())
+        {
+            res = -1;
+            break;
+        }
+
+        if ((m & 63) == 0 && EscapeKeyPressed())
+            break;
+
+        // sieve mD-D/2 .. mD+D/2
+        unsigned int lo = m*ECM_D - ECM_D/2;
+        unsigned int i, k;
+
+        for (i = 0; i <= ECM_D; ++i) comp[i] = false;
+        for (i = 0; i < np; ++i)
+        {
+            p = ps[i];
+            k = (lo + p - 1)/p*p;
+            if (k == p) k += p;
+            for (k -= lo; k <= ECM_D; k += p) comp[k] = true;
+        }
+
+        for (i = 0; i < nb; ++i)
+        {
+            unsigned int s1 = m*ECM_D - bj[i];
+            unsigned int s2 = m*ECM_D + bj[i];
+            if ((!comp[s1 - lo] && s1 > b1 && s1 <= b2) ||
+                (!comp[s2 - lo] && s2 > b1 && s2 <= b2))
+            {
+                acc = (acc * ((u._x*bz[i] - bx[i]*u._z) % n)) % n;
+            }
+        }
+
+        addh(u, g, um, t);
+        um = u;
+        u = t;
+    }
+
+    delete [] ps;
+
+    if (!res)
+    {
+        BigInt d = gcd(acc, n);
+        if (!d.valid()) res = -1;
+        else if (d != 1 && d != n)
+        {
+            f = d;
+            res = 1;
+        }
+    }
+    return res;
+}
+
+static int _ecmCurve(const BigInt& n, unsigned int cc, BigInt& f)
+{
+    // run curve `cc' on n.
+    // return 1 with a factor in `f', 0 for none and -1 if the
+    // arithmetic bailed.
+
+    ECurve ec(n);
+    EPoint p(ec);
+
+    BigInt sg = BigInt(_curveSeed(cc)) + 6;
+    if (sg >= n) sg %= n;
+        
+    BigInt u = (sqr(sg) - 5) % n;
+    BigInt v = (sg<<2) % n;
+
+    BigInt t = subMod(v, u, n);
+    t = (((sqr(t)% n)*t % n) * ( u*3 + v)) % n;
+
+    p._x = ((sqr(u)%n)*u) % n;  // u^3
+
+    BigInt d = ((p._x* v)<<2) % n;
+    BigInt g;
+    d = invert(d, n, g);
+
+    if (g != 1)
+    {
+        f = g;
+        return 1;
+    }
+
+    ec._a = mod(t*d - 2, n);
+    p._z = ((sqr(v)%n) * v) % n;  // v^3
+
+    // slightly increase b1 for each curve
+    unsigned int b1 = 500 + 50*cc;
+
+    // go through all the primes < b1
+    SmallPrimes sp;
+    unsigned int pi = 2;
+    EPoint r(p._c);
+
+    for (;;)
+    {
+        unsigned int pin = pi;
+            
+        for (;;)
+        {
+            unsigned int t = pin*pi;
+            if (t > b1) break;
+            pin = t;
+        }
+            
+        mulnh(p, pin, r);
+
+        if (!r.valid())
+            return -1; // arithmetic bailed
+        p = r;
+
+        pi = sp.next();
+        if (pi > b1) break;
+    }
+
+    // invert z
+    g = gcd(p._z, n);
+    if (g == n) return 0;
+    if (g != 1)
+    {
+        f = g;
+        return 1;
+    }
+    return _ecmStage2(p, b1, ECM_B2*b1, f);
+}
+
+bool Lenstra(const BigInt& n, BigInt& f, int ntrials, int first, int step)
+{
+    // try curves first, first+step, ... below ntrials.
+    // every curve is seeded from its own number, so a host can
+    // split the curves between workers with `first' & `step' and
+    // get the same curves, and the same factors, however many
+    // workers run. on hosts the limb pool and caches are per
+    // thread, so the workers can be threads, see tools/parfactor.
 
     // n is odd
     // n is not divisible by 3
@@ -284,85 +595,106 @@ bool Lenstra(const BigInt& n, BigInt& f, int ntrials)
         }
     }
     
-    // make sequence repeatable
-    setrandomN(1);
-
-    ECurve ec(n);
     int cc;
-    unsigned int b1 = 500;
-
-    EPoint p(ec);
-    for (cc = 0; cc < ntrials; ++cc)
+    for (cc = first; cc < ntrials; cc += step)
     {
         // check for escape
         if (EscapeKeyPressed()) return false;
 
-#ifdef _WIN32
-        //std::cout << "pass " << cc << std::endl;
-#endif
+        int v = _ecmCurve(n, cc, f);
+        if (v) return v > 0;
+    }
+    return false;
+}
 
-        BigInt sg = randomN() + 6;
-        if (sg >= n) sg %= n;
-        
-        BigInt u = (sqr(sg) - 5) % n;
-        BigInt v = (sg<<2) % n;
+#ifndef PRIME_SIEVE_LIMIT
+#define PRIME_SIEVE_LIMIT       4096    // sieve with primes below this
+#endif
+#define PRIME_SIEVE_SPAN        256     // odd candidates per segment
 
-        BigInt t = subMod(v, u, n);
-        t = (((sqr(t)% n)*t % n) * ( u*3 + v)) % n;
+static bool _sievePrime(const BigInt& n0, int dir, BigInt& np)
+{
+    // first prime from odd n0 going up (dir > 0) or down.
+    // the odd numbers are taken a segment at a time and those
+    // with a factor below PRIME_SIEVE_LIMIT are crossed out.
+    // only the rest get the full test.
+    // ASSUME n0 > PRIME_SIEVE_LIMIT, and the prime lies above it.
+    // false if no table or out of memory.
+
+    const unsigned char* gaps;
+    unsigned int nt = smallPrimes(&gaps);
+    unsigned int ns;
+    unsigned short* ps;
+    unsigned short* rs;
+    unsigned int i, k, p;
+    bool comp[PRIME_SIEVE_SPAN];
+    bool found = false;
+
+    // how many table primes are below the limit
+    p = 1;
+    for (ns = 0; ns < nt; ++ns)
+    {
+        p += (unsigned int)gaps[ns] << 1;
+        if (p >= PRIME_SIEVE_LIMIT) break;
+    }
+    if (!ns) return false;
 
-        p._x = ((sqr(u)%n)*u) % n;  // u^3
+    ps = new unsigned short[ns];
+    rs = new unsigned short[ns];
+    if (!ps || !rs)
+    {
+        delete [] ps;
+        delete [] rs;
+        return false;
+    }
 
-        BigInt d = ((p._x* v)<<2) % n;
-        BigInt g;
-        d = invert(d, n, g);
+    // primes to sieve with and n0 mod each
+    p = 1;
+    for (k = 0; k < ns; ++k)
+    {
+        p += (unsigned int)gaps[k] << 1;
+        ps[k] = (unsigned short)p;
+        rs[k] = (unsigned short)n0.modUInt(p);
+    }
 
-        if (g != 1)
+    BigInt c = n0;
+    while (!found)
+    {
+        // candidate i is c + 2i*dir, 
+        // crossed out when 2i*dir = -c mod p
+        for (i = 0; i < PRIME_SIEVE_SPAN; ++i) comp[i] = false;
+        for (k = 0; k < ns; ++k)
         {
-            f = g;
-            return true;
+            p = ps[k];
+            i = dir > 0 ? (p - rs[k]) % p : rs[k];
+            if (i & 1) i += p;
+            for (i >>= 1; i < PRIME_SIEVE_SPAN; i += p) comp[i] = true;
+
+            // step the residue to the next segment
+            i = (2*PRIME_SIEVE_SPAN) % p;
+            rs[k] = dir > 0 ? (rs[k] + i) % p : (rs[k] + p - i) % p;
         }
 
-        ec._a = mod(t*d - 2, n);
-        p._z = ((sqr(v)%n) * v) % n;  // v^3
-
-        // go through all the primes < b1
-        SmallPrimes sp;
-        unsigned int pi = 2;
-        EPoint r(p._c);
-
-        for (;;)
+        for (i = 0; i < PRIME_SIEVE_SPAN; ++i)
         {
-            unsigned int pin = pi;
-            
-            for (;;)
+            if (comp[i]) continue;
+
+            BigInt n = dir > 0 ? c + 2*i : c - 2*i;
+            if (!isOddComposite(n))
             {
-                unsigned int t = pin*pi;
-                if (t > b1) break;
-                pin = t;
+                np = n;
+                found = true;
+                break;
             }
-            
-            mulnh(p, pin, r);
-
-            if (!r.valid())
-                return false; // arithmetic bailed
-            p = r;
-
-            pi = sp.next();
-            if (pi > b1) break;
         }
 
-        // invert z
-        g = gcd(p._z, n);
-        if (g != 1 && g != n)
-        {
-            f = g;
-            return true;
-        }
-        
-        // slightly increase b1 for each curve
-        b1 += 50;
+        if (dir > 0) c += 2*PRIME_SIEVE_SPAN;
+        else c -= 2*PRIME_SIEVE_SPAN;
     }
-    return false;
+
+    delete [] rs;
+    delete [] ps;
+    return true;
 }
 
 bool nextPrime(const BigInt& n0, BigInt& np)
@@ -373,9 +705,13 @@ bool nextPrime(const BigInt& n0, BigInt& np)
         BigInt n;
         if (n0.isEven()) n = n0 + 1;
         else n = n0 + 2;
-        while (isOddComposite(n))
-            n += 2;
-        np = n;
+
+        if (n <= PRIME_SIEVE_LIMIT || !_sievePrime(n, 1, np))
+        {
+            while (isOddComposite(n))
+                n += 2;
+            np = n;
+        }
     }
     return true;
 }
@@ -387,9 +723,15 @@ bool prevPrime(const BigInt& n0, BigInt& np)
         BigInt n;
         if (n0.isEven()) n = n0 - 1;
         else n = n0 - 2;
-        while (isOddComposite(n))
-            n -= 2;
-        np = n;
+
+        // the gap below stays well clear of the sieve primes
+        if (n <= PRIME_SIEVE_LIMIT*PRIME_SIEVE_LIMIT || 
+            !_sievePrime(n, -1, np))
+        {
+            while (isOddComposite(n))
+                n -= 2;
+            np = n;
+        }
     }
     else
     {
@@ -403,7 +745,7 @@ BigInt nRoot(const BigInt& n, unsigned int k)
 {
     unsigned int b = (log2(n) + 1);
     unsigned int bx = (b + k - 1)/k;
-    BigInt x = Big(1)<<bx;
+    BigInt x = BigInt(1)<<bx;
     BigInt x1;
     for (;;)
     {
@@ -29,6 +29,13 @@
 
 #define DEFAULT_PRIMETEST_LIMIT 50
 
+// prime test modes, see setPrimeTest
+#define PRIMETEST_BPSW          0   // baillie-psw
+#define PRIMETEST_WITNESS       1   // witnesses up to the limit
+
+// below this many bits the witnesses are exact and used anyway
+#define BPSW_MINBITS            64
+
 struct SmallDivs
 {
     // generator of small trial divisors
@@ -47,6 +54,80 @@ struct SmallDivs
     unsigned int        _d;
 };
 
+struct SmallPrimes
+{
+    // generate small, odd primes. first from the shared table,
+    // then by trial division.
+    SmallPrimes()
+    {
+        _p = 1;
+        _rp = 1;
+        _rp2 = 4;
+        _ai = 0;
+        _i = 0;
+        _n = smallPrimes(&_gaps);
+    }
+
+    unsigned int next()
+    {
+        // start after the number 7
+        static int add[] = {4, 2, 4, 2, 4, 6, 2, 6};
+
+        if (_i < _n)
+        {
+            _p += (unsigned int)_gaps[_i++] << 1;
+            if (_i == _n)
+            {
+                // pick up the wheel from here
+                static unsigned char at[] = {1, 7, 11, 13, 17, 19, 23, 29};
+                while (at[_ai] != _p % 30) ++_ai;
+                _ai = (_ai + 7) & 0x7;
+            }
+            return _p;
+        }
+
+        if (_p < 7)
+        {
+            // generate 3, 5, 7
+            _p += 2;
+        }
+        else
+        {
+        again:
+            // then > 7, not multiples of 2, 3, 5
+            _p += add[_ai++];
+            _ai &= 0x7;
+        }
+            
+        // adjust root
+        while (_p >= _rp2)
+        {
+            ++_rp;
+            _rp2 = _rp + 1;
+            _rp2 *= _rp2;
+        }
+
+        // now try small divisors up to sqroot
+        SmallDivs sd;
+        unsigned int d = 7;
+
+        while (d <= _rp)
+        {
+            if (_p % d == 0) goto again;
+            d = sd.next();
+        }
+        return _p;
+    }
+    
+    unsigned int        _ai;
+    unsigned int        _p;     // current prime
+    unsigned int        _rp;    // floor(root p)
+    unsigned int        _rp2;   // [floor(root p) + 1]^2
+    const unsigned char* _gaps; // table of primes
+    unsigned int        _n;     // table size
+    unsigned int        _i;     // next in table
+};
+
 struct CompState
 {
     // state of `isComposite' so we can continue testing.
@@ -64,6 +145,13 @@ struct CompState
             _s >>= 1;
             ++_r;
         }
+
+        // keep 1 and n-1 as residues for the tests
+        if (initMont(_mont, _n))
+        {
+            _one = toMont(BigInt(1), _mont);
+            _mnm1 = toMont(_nm1, _mont);
+        }
     }
 
 #if 0
@@ -94,13 +182,11 @@ struct CompState
 
     void                next()
     {
-        static unsigned char primes[] = 
-            { 2, 0, 3, 5, 0, 7 };
-
-        if (_dn < 7)
-            _dn = primes[_dn];
+        // 2, then the odd primes
+        if (!_dn)
+            _dn = 2;
         else
-            _dn = _divs.next();
+            _dn = _primes.next();
     }
 
     const BigInt&       _n;
@@ -109,11 +195,16 @@ struct CompState
     BigInt              _s; // n without 2's
     unsigned int        _r;
     unsigned int        _dn;
-    SmallDivs           _divs;
+    SmallPrimes         _primes;
+    BigMont             _mont; // montgomery context for n
+    BigInt              _one;  // residue of 1
+    BigInt              _mnm1; // residue of n-1
 };
 
 int isPrime(const BigInt&);
-bool Lenstra(const BigInt& n, BigInt& f, int ntrials);
+int setPrimeTest(int mode);
+bool Lenstra(const BigInt& n, BigInt& f, int ntrials,
+             int first = 0, int step = 1);
 bool isOddComposite(CompState& st);
 bool nextPrime(const BigInt& n0, BigInt& np);
 bool prevPrime(const BigInt& n0, BigInt& np);
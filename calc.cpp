@@ -23,6 +23,16 @@
 
 #include <stdio.h>
 #include "calc.h"
+#include "mat.h"
+#include "bcdv.h"
+
+/* default limit on exact integer size. there is one limit for the
+ * whole calculator, it can be raised at run time with `digits' and
+ * stays until changed again.
+ */
+#ifndef MAX_DECIMAL_DIGITS
+#define MAX_DECIMAL_DIGITS      512
+#endif
 
 /** Calc ************************************************************/
 
@@ -37,7 +47,7 @@ Calc::~Calc()
 
 void Calc::start()
 {
-    _maxDecimalDigits = 512; // approx!
+    setMaxDigits(MAX_DECIMAL_DIGITS); // approx!
 
     InitSymbols();
     InitFunctions();
@@ -63,6 +73,10 @@ void Calc::start()
 
 void Calc::clearContext()
 {
+    // cached factors can hold a term from this context
+    LUFactorization::clearCache();
+    finishBCDV();
+
     delete tc_.pop();
     tc_.push();
 }
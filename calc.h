@@ -45,6 +45,9 @@ struct Calc
     {
         _dispFormat.precision(p);
     }
+
+    // limit on the size of exact integers, in decimal digits
+    void                setMaxDigits(int d) { _maxDecimalDigits = d; }
     
     TermRef             approximate(TermRef&);
     void                asString(TermRef& term, TermRef& str);
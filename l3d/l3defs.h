@@ -24,7 +24,7 @@
 #ifndef DEFFS_H
 #define DEFFS_H
 
-#include "BCDh.h"
+#include "bcdh.h"
 #include "misc.h"
 
 // comment this out to remove Goraud support and save code
@@ -50,15 +50,18 @@ static int luDecomp(Mat& a, unsigned int n, int* indx, int*);
 extern void luSolve(const Mat& a, unsigned int n, int* indx,
                     const Mat& b, Mat& x, int col);
 static VALUE luDet(const Mat& a, unsigned int n, int d);
-static void eigenVectors(Mat a, unsigned int n, VALUE * d);
-static void swapRows(Mat a, unsigned int n, unsigned int i, unsigned int j);
-static void svd(Mat a, unsigned int m, unsigned int n, VALUE * w, Mat v);
+static bool eigenVectors(Mat& a, unsigned int n, VALUE * d, bool vectors);
+static void swapRows(Mat& a, unsigned int n, unsigned int i, unsigned int j);
+static void svd(Mat& a, unsigned int m, unsigned int n, VALUE * w, Mat& v);
 static void matMul(const Mat& a, const Mat& b,
                    unsigned int m, unsigned int n, unsigned int l, Mat& c);
-static void svdSub(Mat u, VALUE * w, Mat v, unsigned int m, unsigned int n,
+static void svdSub(Mat& u, VALUE * w, Mat& v, unsigned int m, unsigned int n,
                    VALUE * b, VALUE * x);
+static void svdJacobi(Mat& a, unsigned int m, unsigned int n,
+                      VALUE* w, Mat& v);
 static void balance(Mat& a, int n);
-static bool hqr(const Mat& a, int n, Mat& z);
+static bool hqr(Mat& a, int n, Vec& z);
+static void elmhes(Mat& a, int n);
 static void matAdd(const Mat& a, const Mat& b,
                    unsigned int m, unsigned int n, Mat& c);
 static void matSub(const Mat& a, const Mat& b,
@@ -75,28 +78,63 @@ VALUE SIGN(const VALUE& a, const VALUE& b)
 
 /** Matrix, methods **************************************************/
 
-#if 0
-void Matrix::svd(Matrix& w, Matrix& v)
+bool Matrix::svd(Matrix& u, Matrix& w, Matrix& v) const
 {
-    w.reinit(cols_,1);
-    v.reinit(cols_,cols_);
-    ::svd(m_, rows_, cols_, w.m_, v.m_);
+    /* a = u.diag(w).v^T, singular values `w' as a vector */
+    Mat ud;
+    toDense(ud);
+
+    unsigned int n = _nCols;
+    Mat vd(n, n);
+    Mat wd(1, n);
+    svdJacobi(ud, _nRows, n, wd._d, vd);
+
+    Matrix::_create(u, ud);
+    Matrix::_create(w, wd);
+    Matrix::_create(v, vd);
+    return true;
 }
 
-void Matrix::svdSolve(const Matrix& w, const Matrix& v, 
-                      const Matrix& b, Matrix& x)
+bool Matrix::svdSolve(const Matrix& b, Matrix& x) const
 {
-    x.reinit(cols_, 1);
-    svdSub(m_, w.m_, v.m_, rows_, cols_, b.m_, x.m_);
+    /* least squares solution of a.x = b for a vector `b' */
+    if (b._nRows*b._nCols != _nRows) return false;
+
+    Mat ud;
+    toDense(ud);
+
+    unsigned int n = _nCols;
+    Mat vd(n, n);
+    Mat wd(1, n);
+    svdJacobi(ud, _nRows, n, wd._d, vd);
+
+    // drop singular values that are negligible
+    VALUE wmax = 0;
+    unsigned int j;
+    for (j = 0; j < n; ++j) 
+        if (wd._d[j] > wmax) wmax = wd._d[j];
+    VALUE tol = wmax*BCD::epsilon(20);
+    for (j = 0; j < n; ++j) 
+        if (wd._d[j] <= tol) wd._d[j] = 0;
+
+    Mat bd;
+    b.toDense(bd);
+    Mat xd(1, n);
+    svdSub(ud, wd._d, vd, _nRows, n, bd._d, xd._d);
+    Matrix::_create(x, xd);
+    return true;
 }
-#endif
 
 bool mul(const Matrix& a, const Matrix& b, Matrix& c)
 {
     if (a._nCols == b._nRows)
     {
-        Matrix::_create(c, a._nRows, b._nCols);
-        matMul(a._a, b._a, a._nRows, a._nCols, b._nCols, c._a);
+        Mat ad, bd;
+        a.toDense(ad);
+        b.toDense(bd);
+        Mat cd(a._nRows, b._nCols);
+        matMul(ad, bd, a._nRows, a._nCols, b._nCols, cd);
+        Matrix::_create(c, cd);
         return true;
     }
     return false;
@@ -106,8 +144,12 @@ bool add(const Matrix& a, const Matrix& b, Matrix& c)
 {
     if (a._nCols == b._nCols && a._nRows == b._nRows)
     {
-        Matrix::_create(c, a._nRows, a._nCols);
-        matAdd(a._a, b._a, a._nRows, a._nCols, c._a);
+        Mat ad, bd;
+        a.toDense(ad);
+        b.toDense(bd);
+        Mat cd(a._nRows, a._nCols);
+        matAdd(ad, bd, a._nRows, a._nCols, cd);
+        Matrix::_create(c, cd);
         return true;
     }
     return false;
@@ -117,8 +159,12 @@ bool sub(const Matrix& a, const Matrix& b, Matrix& c)
 {
     if (a._nCols == b._nCols && a._nRows == b._nRows)
     {
-        Matrix::_create(c, a._nRows, a._nCols);
-        matSub(a._a, b._a, a._nRows, a._nCols, c._a);
+        Mat ad, bd;
+        a.toDense(ad);
+        b.toDense(bd);
+        Mat cd(a._nRows, a._nCols);
+        matSub(ad, bd, a._nRows, a._nCols, cd);
+        Matrix::_create(c, cd);
         return true;
     }
     return false;
@@ -126,26 +172,20 @@ bool sub(const Matrix& a, const Matrix& b, Matrix& c)
 
 bool div(const Matrix& a, const Matrix& b, Matrix& c)
 {
-    bool ok = b.isSquare() && a._nRows == b._nRows;
-    if (ok)
+    bool ok;
+    if (b.isSquare())
     {
-        Matrix lub;
-        lub.clone(b);
-        
-        int n = lub._nRows;
-        int cols = a._nCols;
-        int* indx = new int[n];
-        int d;
-        ok = luDecomp(lub._a, n, indx, &d);
+        ok = a._nRows == b._nRows;
         if (ok)
         {
-            Matrix::_create(c, n, cols);
-            for (int j = 0; j < cols; ++j)
-            {
-                luSolve(lub._a, n, indx, a._a, c._a, j); 
-            }
+            LUFactorization* lu = LUFactorization::of(b);
+            ok = lu->solve(a, c);
         }
-        delete [] indx;
+    }
+    else
+    {
+        // overdetermined, least squares for a vector `a'
+        ok = b._nRows > b._nCols && b.svdSolve(a, c);
     }
     return ok;
 }
@@ -173,29 +213,9 @@ bool invert(const Matrix& b, Matrix& c, bool& singular)
             return ok;
         }
 
-        Matrix lub;
-        lub.clone(b);
-        
-        int n = lub._nRows;
-        int* indx = new int[n];
-        int d;
-
-        ok = luDecomp(lub._a, n, indx, &d);
-        if (ok)
-        {
-            Matrix::_create(c, n, n);
-            for (int j = 0; j < n; ++j)
-            {
-                for (int i = 0; i < n; ++i)
-                    MAT(c._a, 0, i, j) = (i == j);
-            
-                luSolve(lub._a, n, indx, c._a, c._a, j); 
-            }
-        }
-        else
-            singular = true;
-
-        delete [] indx;
+        LUFactorization* lu = LUFactorization::of(b);
+        ok = lu->inverse(c);
+        if (!ok) singular = true;
     }
     return ok;
 }
@@ -205,15 +225,8 @@ bool Matrix::determinant(VALUE& det) const
     bool ok = isSquare();
     if (ok)
     {
-        Matrix lub;
-        lub.clone(*this);
-        
-        int n = lub._nRows;
-        int d;
-        if (luDecomp(lub._a, n, 0, &d))
-            det = luDet(lub._a, _nCols, d);
-        else 
-            det = 0; // is singular
+        LUFactorization* lu = LUFactorization::of(*this);
+        det = lu->determinant();
     }
     return ok;
 }
@@ -227,6 +240,97 @@ void transpose(const Matrix& a, Matrix& c)
             VMAT(c._a, c._nRows, j, i) = VMAT(a._a, a._nRows, i, j);
 }
 
+void Matrix::toDense(BCDMatrix& m) const
+{
+    /* copy our array term into dense form */
+    m.resize(_nRows, _nCols);
+    unsigned int i, j;
+    for (i = 0; i < _nRows; ++i) 
+        for (j = 0; j < _nCols; ++j)
+            MAT(m, _nCols, i, j) = VMAT(_a, _nRows, i, j);
+}
+
+void Matrix::_create(Matrix& a, const BCDMatrix& m)
+{
+    /* make an array term from dense form */
+    _create(a, m._nRows, m._nCols);
+    unsigned int i, j;
+    for (i = 0; i < m._nRows; ++i) 
+        for (j = 0; j < m._nCols; ++j)
+            VMAT(a._a, a._nRows, i, j) = MAT(m, m._nCols, i, j);
+}
+
+/** LUFactorization *************************************************/
+
+bool LUFactorization::factor(const Matrix& a)
+{
+    a.toDense(_lu);
+    delete [] _indx;
+    _indx = new int[_lu._nRows];
+    _ok = luDecomp(_lu, _lu._nRows, _indx, &_sign) != 0;
+    _src = a._a;
+    return _ok;
+}
+
+bool LUFactorization::solve(const Matrix& b, Matrix& x) const
+{
+    /* solve A.X = B for all the columns of `b' */
+    if (!_ok || b._nRows != _lu._nRows) return false;
+
+    Mat bd;
+    b.toDense(bd);
+    Mat xd(bd._nRows, bd._nCols);
+    for (unsigned int j = 0; j < bd._nCols; ++j)
+        luSolve(_lu, _lu._nRows, _indx, bd, xd, j);
+    Matrix::_create(x, xd);
+    return true;
+}
+
+bool LUFactorization::inverse(Matrix& x) const
+{
+    if (!_ok) return false;
+
+    int n = _lu._nRows;
+    Mat xd(n, n);
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+            MAT(xd, n, i, j) = (i == j);
+            
+        luSolve(_lu, n, _indx, xd, xd, j); 
+    }
+    Matrix::_create(x, xd);
+    return true;
+}
+
+VALUE LUFactorization::determinant() const
+{
+    if (!_ok) return 0; // is singular
+    return luDet(_lu, _lu._nRows, _sign);
+}
+
+static LUFactorization* luCache;
+
+LUFactorization* LUFactorization::of(const Matrix& a)
+{
+    /* array terms are not modified once built, so the last
+     * factorization is reused while we are asked about the same term.
+     * holding `_src' keeps the term alive so its address cannot be
+     * recycled. the calculator drops it with its context.
+     */
+    if (!luCache) luCache = new LUFactorization;
+    if (!luCache->_src || luCache->_src != a._a)
+        luCache->factor(a);
+    return luCache;
+}
+
+void LUFactorization::clearCache()
+{
+    // release the cached term and its factors
+    delete luCache;
+    luCache = 0;
+}
+
 void Matrix::_create(Matrix& a, int nRows, int nCols, bool complex)
 {
     Array* aa;
@@ -271,8 +375,603 @@ void Matrix::_create(Matrix& a, int nRows, int nCols, bool complex)
     a._a = aa;
 }
 
+/** SparseMatrix ****************************************************/
+
+static void spSortRow(unsigned short* cols, VALUE* vals, unsigned int n)
+{
+    /* insertion sort a row by column, rows are short */
+    for (unsigned int i = 1; i < n; ++i)
+    {
+        unsigned short c = cols[i];
+        VALUE v = vals[i];
+        unsigned int j = i;
+        while (j > 0 && cols[j-1] > c)
+        {
+            cols[j] = cols[j-1];
+            vals[j] = vals[j-1];
+            --j;
+        }
+        cols[j] = c;
+        vals[j] = v;
+    }
+}
+
+static void spMulVec(const SparseMatrix& a, const VALUE* x, VALUE* y)
+{
+    /* y = a.x */
+    for (unsigned int i = 0; i < a.nRows_; ++i)
+    {
+        VALUE s = 0;
+        for (unsigned int k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+            s += a.vals_[k]*x[a.cols_[k]];
+        y[i] = s;
+    }
+}
+
+static void spMulTVec(const SparseMatrix& a, const VALUE* x, VALUE* y)
+{
+    /* y = a^T.x, scattering rows so the transpose is never built */
+    unsigned int i;
+    for (i = 0; i < a.nCols_; ++i) y[i] = 0;
+    for (i = 0; i < a.nRows_; ++i)
+    {
+        if (x[i].isZero()) continue;
+        for (unsigned int k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+            y[a.cols_[k]] += a.vals_[k]*x[i];
+    }
+}
+
+static VALUE spDot(const VALUE* x, const VALUE* y, unsigned int n)
+{
+    VALUE s = 0;
+    for (unsigned int i = 0; i < n; ++i) s += x[i]*y[i];
+    return s;
+}
+
+static bool spSymmetric(const SparseMatrix& a)
+{
+    if (!a.isSquare()) return false;
+
+    TermRef t;
+    transpose(a, t);
+    SparseMatrix* at = SPARSE(t);
+    if (at->nnz_ != a.nnz_) return false;
+
+    unsigned int i;
+    for (i = 0; i <= a.nRows_; ++i)
+        if (at->rows_[i] != a.rows_[i]) return false;
+    for (i = 0; i < a.nnz_; ++i)
+        if (at->cols_[i] != a.cols_[i] || at->vals_[i] != a.vals_[i]) 
+            return false;
+    return true;
+}
+
+static bool spCG(const SparseMatrix& a, const VALUE* b, VALUE* x)
+{
+    /* conjugate gradient for symmetric `a'. breaks down and
+     * returns false if `a' turns out not to be definite.
+     */
+    unsigned int n = a.nRows_;
+    VALUE* r = new VALUE[n];
+    VALUE* p = new VALUE[n];
+    VALUE* q = new VALUE[n];
+
+    unsigned int i;
+    for (i = 0; i < n; ++i)
+    {
+        x[i] = 0;
+        r[i] = b[i];
+        p[i] = b[i];
+    }
+
+    VALUE rr = spDot(r, r, n);
+    VALUE eps = BCD::epsilon(20);
+    VALUE tol = rr*eps*eps;
+
+    bool ok = false;
+    unsigned int maxIt = 4*n + 16;
+    for (unsigned int it = 0; it < maxIt; ++it)
+    {
+        if (rr <= tol) { ok = true; break; }
+
+        spMulVec(a, p, q);
+        VALUE pq = spDot(p, q, n);
+        if (pq <= 0) break; // not positive definite
+        
+        VALUE alpha = rr/pq;
+        for (i = 0; i < n; ++i)
+        {
+            x[i] += alpha*p[i];
+            r[i] -= alpha*q[i];
+        }
+
+        VALUE rr1 = spDot(r, r, n);
+        VALUE beta = rr1/rr;
+        for (i = 0; i < n; ++i) p[i] = r[i] + beta*p[i];
+        rr = rr1;
+    }
+
+    delete [] q;
+    delete [] p;
+    delete [] r;
+    return ok;
+}
+
+static bool spCGNR(const SparseMatrix& a, const VALUE* b, VALUE* x)
+{
+    /* conjugate gradient on the normal equations a^T.a.x = a^T.b
+     * for general `a'. a^T.a is never formed, each step is one
+     * product with `a' and one with its transpose.
+     */
+    unsigned int m = a.nRows_;
+    unsigned int n = a.nCols_;
+    VALUE* r = new VALUE[m];
+    VALUE* q = new VALUE[m];
+    VALUE* s = new VALUE[n];
+    VALUE* p = new VALUE[n];
+
+    unsigned int i;
+    for (i = 0; i < m; ++i) r[i] = b[i];
+    spMulTVec(a, r, s);
+    for (i = 0; i < n; ++i)
+    {
+        x[i] = 0;
+        p[i] = s[i];
+    }
+
+    VALUE ss = spDot(s, s, n);
+    VALUE eps = BCD::epsilon(20);
+    VALUE tol = ss*eps*eps;
+
+    bool ok = false;
+    unsigned int maxIt = 4*n + 16;
+    for (unsigned int it = 0; it < maxIt; ++it)
+    {
+        if (ss <= tol) { ok = true; break; }
+
+        spMulVec(a, p, q);
+        VALUE qq = spDot(q, q, m);
+        if (qq.isZero()) break;
+
+        VALUE alpha = ss/qq;
+        for (i = 0; i < n; ++i) x[i] += alpha*p[i];
+        for (i = 0; i < m; ++i) r[i] -= alpha*q[i];
+
+        spMulTVec(a, r, s);
+        VALUE ss1 = spDot(s, s, n);
+        VALUE beta = ss1/ss;
+        for (i = 0; i < n; ++i) p[i] = s[i] + beta*p[i];
+        ss = ss1;
+    }
+
+    delete [] p;
+    delete [] s;
+    delete [] q;
+    delete [] r;
+    return ok;
+}
+
+bool sparse(const Matrix& a, TermRef& c)
+{
+    /* compress a real array term */
+    if (!a._nRows) return false;
+
+    unsigned int i, j;
+    unsigned int nnz = 0;
+    for (i = 0; i < a._nRows; ++i) 
+        for (j = 0; j < a._nCols; ++j)
+            if (!VMAT(a._a, a._nRows, i, j).isZero()) ++nnz;
+
+    SparseMatrix* s = SparseMatrix::create(a._nRows, a._nCols, nnz);
+    c = s;
+
+    unsigned int k = 0;
+    for (i = 0; i < a._nRows; ++i) 
+    {
+        s->rows_[i] = k;
+        for (j = 0; j < a._nCols; ++j)
+        {
+            VALUE v = VMAT(a._a, a._nRows, i, j);
+            if (!v.isZero())
+            {
+                s->cols_[k] = j;
+                s->vals_[k] = v;
+                ++k;
+            }
+        }
+    }
+    s->rows_[i] = k;
+    return true;
+}
+
+static bool spIndex(const VALUE& x, unsigned int& i)
+{
+    // 1 based index to 0 based, within a term's size
+    if (!x.isInteger() || x < 1 || x > 0xffff) return false;
+    i = itrunc(x) - 1;
+    return true;
+}
+
+bool sparse(const Matrix& ri, const Matrix& ci, const Matrix& v,
+            TermRef& c)
+{
+    /* build from triplets, v[k] at row ri[k], column ci[k], 1 based,
+     * so that no dense copy is ever made. the size is the largest
+     * index each way. repeated positions are summed.
+     */
+    unsigned int n = v._nCols;
+    if (v._nRows != 1 || ri._nRows != 1 || ci._nRows != 1) return false;
+    if (ri._nCols != n || ci._nCols != n) return false;
+
+    unsigned int* r = new unsigned int[n];
+    unsigned int* col = new unsigned int[n];
+    unsigned int* ord = new unsigned int[n];
+    unsigned int nr = 0;
+    unsigned int nc = 0;
+    unsigned int i, k, l;
+    bool ok = true;
+
+    for (k = 0; ok && k < n; ++k)
+    {
+        ok = spIndex(VEC(ri._a, k), r[k]) && spIndex(VEC(ci._a, k), col[k]);
+        if (ok)
+        {
+            if (r[k] >= nr) nr = r[k] + 1;
+            if (col[k] >= nc) nc = col[k] + 1;
+        }
+    }
+
+    unsigned int* start = 0;
+    if (ok)
+    {
+        // bucket by row, start[i] is the first of row i
+        start = new unsigned int[nr+1];
+        for (i = 0; i <= nr; ++i) start[i] = 0;
+        for (k = 0; k < n; ++k) ++start[r[k]+1];
+        for (i = 0; i < nr; ++i) start[i+1] += start[i];
+        for (k = 0; k < n; ++k) ord[start[r[k]]++] = k;
+        for (i = nr; i > 0; --i) start[i] = start[i-1];
+        start[0] = 0;
+
+        // columns ascending within each row
+        for (i = 0; i < nr; ++i)
+        {
+            for (k = start[i] + 1; k < start[i+1]; ++k)
+            {
+                unsigned int t = ord[k];
+                for (l = k; l > start[i] && col[ord[l-1]] > col[t]; --l)
+                    ord[l] = ord[l-1];
+                ord[l] = t;
+            }
+        }
+
+        /* twice over the sorted entries, first to count what is
+         * left after summing repeats, then to store it.
+         */
+        SparseMatrix* s = 0;
+        unsigned int nnz = 0;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            unsigned int m = 0;
+            for (i = 0; i < nr; ++i)
+            {
+                if (s) s->rows_[i] = m;
+                for (k = start[i]; k < start[i+1]; k = l)
+                {
+                    VALUE sum = VEC(v._a, ord[k]);
+                    for (l = k + 1; l < start[i+1] && 
+                             col[ord[l]] == col[ord[k]]; ++l)
+                        sum += VEC(v._a, ord[l]);
+
+                    if (!sum.isZero())
+                    {
+                        if (s)
+                        {
+                            s->cols_[m] = col[ord[k]];
+                            s->vals_[m] = sum;
+                        }
+                        ++m;
+                    }
+                }
+            }
+
+            if (s) s->rows_[i] = m;
+            else
+            {
+                nnz = m;
+                s = SparseMatrix::create(nr, nc, nnz);
+                c = s;
+            }
+        }
+    }
+
+    delete [] start;
+    delete [] ord;
+    delete [] col;
+    delete [] r;
+    return ok;
+}
+
+void dense(const SparseMatrix& a, Matrix& c)
+{
+    Mat cd(a.nRows_, a.nCols_);
+    unsigned int i;
+    for (i = 0; i < cd._nRows*cd._nCols; ++i) cd._d[i] = 0;
+    for (i = 0; i < a.nRows_; ++i)
+        for (unsigned int k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+            MAT(cd, cd._nCols, i, a.cols_[k]) = a.vals_[k];
+    Matrix::_create(c, cd);
+}
+
+bool add(const SparseMatrix& a, const SparseMatrix& b, TermRef& c)
+{
+    if (a.nRows_ != b.nRows_ || a.nCols_ != b.nCols_) return false;
+
+    /* merge the rows, the result can be no larger than both */
+    SparseMatrix* s = SparseMatrix::create(a.nRows_, a.nCols_, 
+                                           a.nnz_ + b.nnz_);
+    c = s;
+
+    unsigned int k = 0;
+    unsigned int i;
+    for (i = 0; i < a.nRows_; ++i)
+    {
+        s->rows_[i] = k;
+        unsigned int ka = a.rows_[i];
+        unsigned int kb = b.rows_[i];
+        while (ka < a.rows_[i+1] || kb < b.rows_[i+1])
+        {
+            unsigned int col;
+            VALUE v;
+            if (kb >= b.rows_[i+1] ||
+                (ka < a.rows_[i+1] && a.cols_[ka] < b.cols_[kb]))
+            {
+                col = a.cols_[ka];
+                v = a.vals_[ka++];
+            }
+            else if (ka >= a.rows_[i+1] || b.cols_[kb] < a.cols_[ka])
+            {
+                col = b.cols_[kb];
+                v = b.vals_[kb++];
+            }
+            else
+            {
+                col = a.cols_[ka];
+                v = a.vals_[ka++] + b.vals_[kb++];
+            }
+
+            if (!v.isZero()) // drop cancellations
+            {
+                s->cols_[k] = col;
+                s->vals_[k] = v;
+                ++k;
+            }
+        }
+    }
+    s->rows_[i] = k;
+    s->nnz_ = k;
+    return true;
+}
+
+bool mul(const SparseMatrix& a, const SparseMatrix& b, TermRef& c)
+{
+    if (a.nCols_ != b.nRows_) return false;
+
+    /* row by row (Gustavson). first pass counts the structure of
+     * each result row using `mark', second accumulates into `acc'.
+     */
+    unsigned int n = b.nCols_;
+    unsigned int* mark = new unsigned int[n];
+    unsigned int i, j, k, kb;
+
+    for (j = 0; j < n; ++j) mark[j] = (unsigned int)-1;
+    unsigned int nnz = 0;
+    for (i = 0; i < a.nRows_; ++i)
+        for (k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+        {
+            unsigned int r = a.cols_[k];
+            for (kb = b.rows_[r]; kb < b.rows_[r+1]; ++kb)
+            {
+                j = b.cols_[kb];
+                if (mark[j] != i) 
+                {
+                    mark[j] = i;
+                    ++nnz;
+                }
+            }
+        }
+
+    SparseMatrix* s = SparseMatrix::create(a.nRows_, n, nnz);
+    c = s;
+
+    VALUE* acc = new VALUE[n];
+    for (j = 0; j < n; ++j) mark[j] = (unsigned int)-1;
+
+    unsigned int m = 0;
+    for (i = 0; i < a.nRows_; ++i)
+    {
+        unsigned int start = m;
+        s->rows_[i] = m;
+        for (k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+        {
+            unsigned int r = a.cols_[k];
+            const VALUE& av = a.vals_[k];
+            for (kb = b.rows_[r]; kb < b.rows_[r+1]; ++kb)
+            {
+                j = b.cols_[kb];
+                if (mark[j] != i)
+                {
+                    mark[j] = i;
+                    acc[j] = 0;
+                    s->cols_[m++] = j;
+                }
+                acc[j] += av*b.vals_[kb];
+            }
+        }
+
+        // gather, dropping cancellations
+        unsigned int e = start;
+        for (k = start; k < m; ++k)
+        {
+            j = s->cols_[k];
+            if (!acc[j].isZero())
+            {
+                s->cols_[e] = j;
+                s->vals_[e] = acc[j];
+                ++e;
+            }
+        }
+        m = e;
+        spSortRow(s->cols_ + start, s->vals_ + start, m - start);
+    }
+    s->rows_[i] = m;
+    s->nnz_ = m;
+
+    delete [] acc;
+    delete [] mark;
+    return true;
+}
+
+bool mul(const SparseMatrix& a, const Matrix& b, Matrix& c)
+{
+    /* sparse times dense is dense. a vector `b' is taken as a
+     * column and gives a vector back.
+     */
+    if (b._nRows == 1 && b._nCols == a.nCols_ && a.nCols_ > 1)
+    {
+        Mat bd;
+        b.toDense(bd);
+        Mat cd(1, a.nRows_);
+        spMulVec(a, bd._d, cd._d);
+        Matrix::_create(c, cd);
+        return true;
+    }
+
+    if (b._nRows != a.nCols_) return false;
+
+    Mat bd;
+    b.toDense(bd);
+    unsigned int nc = b._nCols;
+    Mat cd(a.nRows_, nc);
+    unsigned int i, j;
+    for (i = 0; i < a.nRows_; ++i)
+    {
+        VALUE* ci = &MAT(cd, nc, i, 0);
+        for (j = 0; j < nc; ++j) ci[j] = 0;
+        for (unsigned int k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+        {
+            const VALUE& av = a.vals_[k];
+            const VALUE* bk = &MAT(bd, nc, a.cols_[k], 0);
+            for (j = 0; j < nc; ++j) ci[j] += av*bk[j];
+        }
+    }
+    Matrix::_create(c, cd);
+    return true;
+}
+
+void mul(const SparseMatrix& a, const VALUE& v, TermRef& c)
+{
+    SparseMatrix* s = SparseMatrix::create(a.nRows_, a.nCols_, a.nnz_);
+    c = s;
+
+    unsigned int i;
+    unsigned int k = 0;
+    for (i = 0; i < a.nRows_; ++i)
+    {
+        s->rows_[i] = k;
+        for (unsigned int ka = a.rows_[i]; ka < a.rows_[i+1]; ++ka)
+        {
+            VALUE t = a.vals_[ka]*v;
+            if (!t.isZero())
+            {
+                s->cols_[k] = a.cols_[ka];
+                s->vals_[k] = t;
+                ++k;
+            }
+        }
+    }
+    s->rows_[i] = k;
+    s->nnz_ = k;
+}
+
+void transpose(const SparseMatrix& a, TermRef& c)
+{
+    /* counting sort on column, which leaves the rows of the
+     * result in column order.
+     */
+    SparseMatrix* s = SparseMatrix::create(a.nCols_, a.nRows_, a.nnz_);
+    c = s;
+
+    unsigned int i, k;
+    for (i = 0; i <= s->nRows_; ++i) s->rows_[i] = 0;
+    for (k = 0; k < a.nnz_; ++k) ++s->rows_[a.cols_[k] + 1];
+    for (i = 0; i < s->nRows_; ++i) s->rows_[i+1] += s->rows_[i];
+
+    unsigned int* next = new unsigned int[s->nRows_];
+    for (i = 0; i < s->nRows_; ++i) next[i] = s->rows_[i];
+    for (i = 0; i < a.nRows_; ++i)
+        for (k = a.rows_[i]; k < a.rows_[i+1]; ++k)
+        {
+            unsigned int d = next[a.cols_[k]]++;
+            s->cols_[d] = i;
+            s->vals_[d] = a.vals_[k];
+        }
+    delete [] next;
+}
+
+bool div(const Matrix& a, const SparseMatrix& b, Matrix& c)
+{
+    /* solve b.X = a iteratively, so that storage stays in
+     * proportion to the nonzeros of `b'. conjugate gradient when
+     * `b' is symmetric, otherwise (or if that breaks down) on the
+     * normal equations. a vector `a' is taken as a column.
+     */
+    if (!b.isSquare()) return false;
+
+    unsigned int n = b.nRows_;
+    bool isVec = a._nRows == 1 && a._nCols == n && n > 1;
+    if (!isVec && a._nRows != n) return false;
+
+    Mat ad;
+    a.toDense(ad);
+
+    unsigned int nc = isVec ? 1 : ad._nCols;
+    Mat xd;
+    if (isVec) xd.resize(1, n);
+    else xd.resize(n, nc);
+
+    VALUE* bj = new VALUE[n];
+    VALUE* xj = new VALUE[n];
+    bool sym = spSymmetric(b);
+
+    bool ok = true;
+    unsigned int i, j;
+    for (j = 0; ok && j < nc; ++j)
+    {
+        for (i = 0; i < n; ++i) 
+            bj[i] = isVec ? ad._d[i] : MAT(ad, nc, i, j);
+
+        ok = (sym && spCG(b, bj, xj)) || spCGNR(b, bj, xj);
+
+        for (i = 0; i < n; ++i) 
+        {
+            if (isVec) xd._d[i] = xj[i];
+            else MAT(xd, nc, i, j) = xj[i];
+        }
+    }
+
+    delete [] xj;
+    delete [] bj;
+    if (ok) Matrix::_create(c, xd);
+    return ok;
+}
+
 /** General code ****************************************************/
 
+#ifndef LU_BLOCK
+#define LU_BLOCK 8
+#endif
+
 int luDecomp(Mat& a, unsigned int n, int* indx, int* d)
 {
     /* LU Decomposition.
@@ -281,19 +980,25 @@ int luDecomp(Mat& a, unsigned int n, int* indx, int* d)
      * and `indx' records the permutations and `d' is +/-1 depending
      * on even or odd row interchanges.
      *
+     * right-looking and blocked. each panel of LU_BLOCK columns is
+     * factored with implicit (scaled) partial pivoting, then the rows
+     * of U to its right are solved and the trailing matrix updated
+     * in one pass.
+     *
      * Return 1 if ok.
      */
 
-    int i, imax, j, k;
-    VALUE  big, sum, t;
+    int i, imax, j, k, c, jb, je;
+    int nn = n;
+    VALUE  big, t;
     VALUE * vv;
     
     vv = new VALUE[n];
     *d = 1;
-    for (i = 0; i < n; ++i) 
+    for (i = 0; i < nn; ++i) 
     {
         big = 0;
-        for (j = 0; j < n; ++j) 
+        for (j = 0; j < nn; ++j) 
         {
             t = fabs(MAT(a,n,i,j));
             if (t > big) big = t;
@@ -307,54 +1012,78 @@ int luDecomp(Mat& a, unsigned int n, int* indx, int* d)
         vv[i] = VALUE(1)/big;
     }
 
-    for (j = 0; j < n; ++j) 
+    for (jb = 0; jb < nn; jb += LU_BLOCK) 
     {
-        for (i = 0; i < j; ++i) 
-        {
-            sum = MAT(a, n, i, j);
-            for (k = 0; k < i; ++k) sum -= MAT(a,n,i,k) * MAT(a,n,k,j);
-            MAT(a,n,i,j) = sum;
-        }
-        big = 0;
-        for (i = j; i < n; ++i) 
+        je = jb + LU_BLOCK;
+        if (je > nn) je = nn;
+
+        /* factor the panel */
+        for (j = jb; j < je; ++j) 
         {
-            sum = MAT(a,n,i,j);
-            for (k = 0; k < j; ++k) sum -= MAT(a,n,i,k) * MAT(a,n,k,j);
-            MAT(a,n,i,j) = sum;
-            t = vv[i] * fabs(sum);
-            if (t >= big) 
+            big = 0;
+            imax = j;
+            for (i = j; i < nn; ++i) 
             {
-                big = t;
-                imax = i;
+                t = vv[i] * fabs(MAT(a,n,i,j));
+                if (t >= big) 
+                {
+                    big = t;
+                    imax = i;
+                }
             }
-        }
-        if (j != imax) 
-        {
-            for (k = 0; k < n; ++k) 
+            if (j != imax) 
             {
-                t = MAT(a,n,imax,k);
-                MAT(a,n,imax,k) = MAT(a,n,j,k);
-                MAT(a,n,j,k) = t;
+                for (k = 0; k < nn; ++k) 
+                {
+                    t = MAT(a,n,imax,k);
+                    MAT(a,n,imax,k) = MAT(a,n,j,k);
+                    MAT(a,n,j,k) = t;
+                }
+                *d = -(*d);
+                vv[imax] = vv[j];
             }
-            *d = -(*d);
-            vv[imax] = vv[j];
-        }
 
-        if (indx) indx[j] = imax;
-        if (MAT(a,n,j,j) == 0)
-        {
-            // singular matrix. we can either perturb it and 
-            // continue - or bail.
-            // right now, we bail since we should be using SVD in any case.
-            //MAT(a,n,j,j) = TINY;
+            if (indx) indx[j] = imax;
+            if (MAT(a,n,j,j) == 0)
+            {
+                // singular matrix. we can either perturb it and 
+                // continue - or bail.
+                // right now, we bail since we should be using SVD in any case.
+                //MAT(a,n,j,j) = TINY;
 
-            delete [] vv;
-            return 0;
+                delete [] vv;
+                return 0;
+            }
+
+            t = VALUE(1)/MAT(a,n,j,j);
+            for (i = j+1; i < nn; ++i) 
+            {
+                VALUE& lij = MAT(a,n,i,j);
+                lij *= t;
+                for (k = j+1; k < je; ++k) 
+                    MAT(a,n,i,k) -= lij*MAT(a,n,j,k);
+            }
         }
-        if (j != n-1) 
+
+        if (je < nn)
         {
-            t = VALUE(1)/MAT(a,n,j,j);
-            for (i = j+1; i < n; ++i) MAT(a,n,i,j) *= t;
+            /* rows of U right of the panel */
+            for (j = jb+1; j < je; ++j) 
+                for (k = jb; k < j; ++k) 
+                {
+                    const VALUE& ljk = MAT(a,n,j,k);
+                    for (c = je; c < nn; ++c) 
+                        MAT(a,n,j,c) -= ljk*MAT(a,n,k,c);
+                }
+
+            /* trailing update */
+            for (i = je; i < nn; ++i) 
+                for (k = jb; k < je; ++k) 
+                {
+                    const VALUE& lik = MAT(a,n,i,k);
+                    for (c = je; c < nn; ++c) 
+                        MAT(a,n,i,c) -= lik*MAT(a,n,k,c);
+                }
         }
     }
 
@@ -397,9 +1126,14 @@ void luSolve(const Mat& a, unsigned int n, int* indx,
     }
 }
 
-#if 0
-static void householderReduction(Mat a, int n, VALUE * d, VALUE * e)
+static void householderReduction(Mat& a, int n, VALUE * d, VALUE * e,
+                                 bool vectors)
 {
+    /* reduce symmetric `a' to tridiagonal form, diagonal in `d' and
+     * off diagonal in `e'. if `vectors', `a' is replaced by the
+     * orthogonal transform, otherwise only the values are wanted and
+     * the accumulation is skipped.
+     */
     int l, k, j, i;
     VALUE  scale, hh, h, g, f;
 
@@ -426,7 +1160,7 @@ static void householderReduction(Mat a, int n, VALUE * d, VALUE * e)
                 f = 0;
                 for (j = 0; j <= l; ++j) 
                 {
-                    MAT(a,n,j,i) = MAT(a,n,i,j)/h;
+                    if (vectors) MAT(a,n,j,i) = MAT(a,n,i,j)/h;
                     g = 0;
                     for (k = 0; k <= j; ++k) g += MAT(a,n,j,k)*MAT(a,n,i,k);
                     for (k = j+1; k <= l; ++k) g += MAT(a,n,k,j)*MAT(a,n,i,k);
@@ -452,6 +1186,13 @@ static void householderReduction(Mat a, int n, VALUE * d, VALUE * e)
 
     d[0] = 0;
     e[0] = 0;
+
+    if (!vectors)
+    {
+        for (i = 0; i < n; ++i) d[i] = MAT(a,n,i,i);
+        return;
+    }
+
     for (i = 0; i < n; ++i) 
     {
         if (d[i] != 0) 
@@ -473,7 +1214,7 @@ static void householderReduction(Mat a, int n, VALUE * d, VALUE * e)
     }
 }
 
-static void tridiagQL(VALUE* d, VALUE* e, int n, Mat a)
+static bool tridiagQL(VALUE* d, VALUE* e, int n, Mat& a, bool vectors)
 {
     int m, l, iter, i, k;
     VALUE  s, r, p, g, f, dd, c, b;
@@ -496,7 +1237,7 @@ static void tridiagQL(VALUE* d, VALUE* e, int n, Mat a)
                 if (++iter == 30) 
                 {
                     // printf("too many iterations\n");
-                    return;
+                    return false;
                 }
 
                 g = (d[l+1]-d[l])/(VALUE(2)*e[l]);
@@ -523,7 +1264,7 @@ static void tridiagQL(VALUE* d, VALUE* e, int n, Mat a)
                     p = s*r;
                     d[i+1] = g+p;
                     g = c*r-b;
-                    for (k = 0; k<n; ++k) 
+                    if (vectors) for (k = 0; k<n; ++k) 
                     {
                         f = MAT(a,n,k,i+1);
                         MAT(a,n,k,i+1) = s*MAT(a,n,k,i) + c*f;
@@ -537,21 +1278,46 @@ static void tridiagQL(VALUE* d, VALUE* e, int n, Mat a)
             }
         } while (m != l);
     }
+    return true;
 }
 
-void eigenVectors(Mat a, unsigned int n, VALUE * d)
+bool eigenVectors(Mat& a, unsigned int n, VALUE * d, bool vectors)
 {
-    /* `a' is symmetric */
+    /* `a' is symmetric.
+     * eigenvalues into `d' and, if `vectors', eigenvectors as
+     * the columns of `a'.
+     */
+
+    unsigned int i, j;
+    bool diag = true;
+    for (i = 0; i < n && diag; ++i) 
+        for (j = 0; j < i; ++j) 
+            if (MAT(a,n,i,j) != 0) { diag = false; break; }
+
+    if (diag)
+    {
+        // already diagonal, nothing to do
+        for (i = 0; i < n; ++i) 
+        {
+            d[i] = MAT(a,n,i,i);
+            if (vectors)
+                for (j = 0; j < n; ++j) MAT(a,n,i,j) = (i == j);
+        }
+        return true;
+    }
 
     VALUE* e = new VALUE[n];
 
     /* first perform reduction to tridiagonal form */
-    householderReduction(a, n, d, e);
-    tridiagQL(d, e, n, a);
+    householderReduction(a, n, d, e, vectors);
+    bool ok = tridiagQL(d, e, n, a, vectors);
     delete [] e;
+    return ok;
 }
 
-void swapRows(Mat a, unsigned int n, unsigned int i, unsigned int j)
+#if 0
+
+void swapRows(Mat& a, unsigned int n, unsigned int i, unsigned int j)
 {
     unsigned int k;
     for (k = 0; k < n; ++k) 
@@ -562,7 +1328,7 @@ void swapRows(Mat a, unsigned int n, unsigned int i, unsigned int j)
     }
 }
 
-void svd(Mat a, unsigned int m, unsigned int n, VALUE* w, Mat v)
+void svd(Mat& a, unsigned int m, unsigned int n, VALUE* w, Mat& v)
 {
     /* Singular Value Decomposition.
      *
@@ -815,58 +1581,65 @@ void matAdd(const Mat& a, const Mat& b,
             unsigned int m, unsigned int n, Mat& c)
 {
     /* a(m,n) + b(m,n) -> c(m,n) */
-    int i, j;
-
-    if (m == 1) // 1 row
-        // vector add
-        for (i = 0; i < n; ++i) VEC(c,i) = VEC(a,i) + VEC(b,i);
-    else
-    {
-        for (i = 0; i < m; ++i) 
-            for (j = 0; j < n; ++j) 
-                MAT(c,n,i,j) = MAT(a,n,i,j)+MAT(b,n,i,j);
-    }
+    unsigned int i;
+    for (i = 0; i < m*n; ++i) c._d[i] = a._d[i] + b._d[i];
 }
 
 void matSub(const Mat& a, const Mat& b,
             unsigned int m, unsigned int n, Mat& c)
 {
     /* a(m,n) - b(m,n) -> c(m,n) */
-    int i, j;
-
-    if (m == 1) // 1 row
-        // vector add
-        for (i = 0; i < n; ++i) VEC(c,i) = VEC(a,i) - VEC(b,i);
-    else
-    {
-        for (i = 0; i < m; ++i) 
-            for (j = 0; j < n; ++j) 
-                MAT(c,n,i,j) = MAT(a,n,i,j)-MAT(b,n,i,j);
-    }
+    unsigned int i;
+    for (i = 0; i < m*n; ++i) c._d[i] = a._d[i] - b._d[i];
 }
 
+#ifndef MATMUL_TILE
+#define MATMUL_TILE 16
+#endif
+
 void matMul(const Mat& a, const Mat& b,
             unsigned int m, unsigned int n, unsigned int l, Mat& c)
 {
-    /* a(m,n) * b(n,l) -> c(m,l) */
+    /* a(m,n) * b(n,l) -> c(m,l) 
+     *
+     * blocked over tiles of `b' so that each tile is reused for every
+     * row of `a' while it is still in cache. each c(i,j) still sums
+     * over k in ascending order, so the result is identical to the
+     * plain triple loop.
+     */
 
-    unsigned int i, j, k;
-    VALUE t;
+    unsigned int i, j, k, jj, kk, je, ke;
+
+    for (i = 0; i < m*l; ++i) c._d[i] = 0;
 
-    for (i = 0; i < m; ++i) 
-        for (j = 0; j < l; ++j) 
+    for (jj = 0; jj < l; jj += MATMUL_TILE) 
+    {
+        je = jj + MATMUL_TILE;
+        if (je > l) je = l;
+
+        for (kk = 0; kk < n; kk += MATMUL_TILE) 
         {
-            t = 0;
-            for (k = 0; k < n; ++k) t += VMAT(a,m,i,k)*VMAT(b,n,k,j);
-            VMAT(c,m,i,j) = t;
+            ke = kk + MATMUL_TILE;
+            if (ke > n) ke = n;
+
+            for (i = 0; i < m; ++i) 
+            {
+                VALUE* ci = &MAT(c,l,i,0);
+                for (k = kk; k < ke; ++k) 
+                {
+                    const VALUE& aik = MAT(a,n,i,k);
+                    const VALUE* bk = &MAT(b,l,k,0);
+                    for (j = jj; j < je; ++j) ci[j] += aik*bk[j];
+                }
+            }
         }
+    }
 }
 
-#if 0
-void svdSub(Mat u, VALUE * w, Mat v, unsigned int m, unsigned int n,
+void svdSub(Mat& u, VALUE * w, Mat& v, unsigned int m, unsigned int n,
             VALUE * b, VALUE * x)
 {
-    int k, j, i;
+    unsigned int k, j, i;
     VALUE  s;
     VALUE * tv;
 
@@ -890,7 +1663,140 @@ void svdSub(Mat u, VALUE * w, Mat v, unsigned int m, unsigned int n,
     }
     delete [] tv;
 }
-#endif
+
+static bool jacobiRotate(Mat& a, unsigned int m, unsigned int n,
+                         Mat& v, int p, int q, const VALUE& eps)
+{
+    /* orthogonalise columns `p' and `q' of `a', accumulating the
+     * rotation into `v'. return false if they already are.
+     */
+    unsigned int i;
+    VALUE alpha = 0;
+    VALUE beta = 0;
+    VALUE gamma = 0;
+    for (i = 0; i < m; ++i)
+    {
+        const VALUE& ap = MAT(a,n,i,p);
+        const VALUE& aq = MAT(a,n,i,q);
+        alpha += ap*ap;
+        beta += aq*aq;
+        gamma += ap*aq;
+    }
+
+    if (gamma == 0 || fabs(gamma) <= eps*sqrt(alpha*beta)) return false;
+
+    VALUE zeta = (beta - alpha)/(gamma*2);
+    VALUE t = VALUE(1)/(fabs(zeta) + sqrt(zeta*zeta + 1));
+    if (zeta < 0) t = -t;
+    VALUE c = VALUE(1)/sqrt(t*t + 1);
+    VALUE s = c*t;
+
+    VALUE x, y;
+    for (i = 0; i < m; ++i)
+    {
+        x = MAT(a,n,i,p);
+        y = MAT(a,n,i,q);
+        MAT(a,n,i,p) = c*x - s*y;
+        MAT(a,n,i,q) = s*x + c*y;
+    }
+    for (i = 0; i < n; ++i)
+    {
+        x = MAT(v,n,i,p);
+        y = MAT(v,n,i,q);
+        MAT(v,n,i,p) = c*x - s*y;
+        MAT(v,n,i,q) = s*x + c*y;
+    }
+    return true;
+}
+
+void svdJacobi(Mat& a, unsigned int m, unsigned int n, VALUE* w, Mat& v)
+{
+    /* Singular Value Decomposition, one-sided Jacobi.
+     *
+     * a(m,n) -> u(m,n) * w(n) * v(n,n)^T 
+     * where a is replaced by u, as svd.
+     *
+     * pairs of columns are rotated until all are orthogonal. each
+     * sweep visits the pairs round-robin, so that every round is
+     * a set of disjoint pairs. w is returned in decreasing order.
+     */
+
+    unsigned int i, j, k;
+    int r, its;
+    VALUE eps = BCD::epsilon(23);
+
+    for (i = 0; i < n; ++i)
+        for (j = 0; j < n; ++j) MAT(v,n,i,j) = (i == j);
+
+    // round-robin schedule, pad to even with a dummy column `n'
+    int np = n + (n & 1);
+    int* order = new int[np];
+    for (i = 0; i < (unsigned int)np; ++i) order[i] = i;
+
+    for (its = 0; its < 30; ++its)
+    {
+        bool rotated = false;
+        for (r = 0; r < np-1; ++r)
+        {
+            for (k = 0; k < (unsigned int)np/2; ++k)
+            {
+                int p = order[k];
+                int q = order[np-1-k];
+                if (p == (int)n || q == (int)n) continue;
+                if (p > q) { int t = p; p = q; q = t; }
+                if (jacobiRotate(a, m, n, v, p, q, eps)) rotated = true;
+            }
+
+            // rotate all but the first
+            int last = order[np-1];
+            for (k = np-1; k > 1; --k) order[k] = order[k-1];
+            order[1] = last;
+        }
+        if (!rotated) break;
+    }
+    delete [] order;
+
+    // singular values are the column norms
+    VALUE wmax = 0;
+    for (j = 0; j < n; ++j)
+    {
+        VALUE s = 0;
+        for (i = 0; i < m; ++i) s += MAT(a,n,i,j)*MAT(a,n,i,j);
+        w[j] = sqrt(s);
+        if (w[j] > wmax) wmax = w[j];
+    }
+
+    // columns left at rounding level are null space, not directions
+    VALUE tiny = wmax*eps;
+    for (j = 0; j < n; ++j)
+    {
+        if (w[j] <= tiny) w[j] = 0;
+        else
+        {
+            VALUE t = VALUE(1)/w[j];
+            for (i = 0; i < m; ++i) MAT(a,n,i,j) *= t;
+        }
+    }
+
+    // sort decreasing, moving the columns of u and v with them
+    for (j = 0; j < n; ++j)
+    {
+        k = j;
+        for (i = j+1; i < n; ++i) if (w[i] > w[k]) k = i;
+        if (k != j)
+        {
+            VALUE t = w[j]; w[j] = w[k]; w[k] = t;
+            for (i = 0; i < m; ++i)
+            {
+                t = MAT(a,n,i,j); MAT(a,n,i,j) = MAT(a,n,i,k); MAT(a,n,i,k) = t;
+            }
+            for (i = 0; i < n; ++i)
+            {
+                t = MAT(v,n,i,j); MAT(v,n,i,j) = MAT(v,n,i,k); MAT(v,n,i,k) = t;
+            }
+        }
+    }
+}
 
 /* routines for eigenvalues of non-symmetric matrices */
 
@@ -944,8 +1850,9 @@ void balance(Mat& a, int n)
 }
 
 
-void squelchMat(const Mat& a, int n, const VALUE& eps)
+void squelchMat(Mat& a, int n, const VALUE& eps)
 {
+    /* zero negligible elements of the leading n x n block */
     int i, j;
     for (i = 0; i < n; ++i)
     {
@@ -954,7 +1861,7 @@ void squelchMat(const Mat& a, int n, const VALUE& eps)
     }
 }
 
-bool hqr(const Mat& a, int n, Mat& mz)
+bool hqr(Mat& a, int n, Vec& mz)
 {
     /* find eigenvalues of upper hessenberg square Matrix `a' of
      * size nxn.
@@ -981,7 +1888,8 @@ bool hqr(const Mat& a, int n, Mat& mz)
         it = 0;
         do 
         {
-            squelchMat(a,n, eps*norm);
+            // rows and columns past `nn' are deflated and not used again
+            squelchMat(a,nn+1, eps*norm);
             //printMat(a,n);
 
             for (l=nn; l > 0; --l) 
@@ -1182,6 +2090,104 @@ bool hqr(const Mat& a, int n, Mat& mz)
     return true;
 }
 
+void elmhes(Mat& a, int n)
+{
+    /* reduce `a' to upper hessenberg form by elimination with 
+     * pivoting. eigenvalues are preserved. 
+     */
+    int m, j, i;
+    VALUE x, y, t;
+
+    for (m = 1; m < n-1; ++m) 
+    {
+        x = 0;
+        i = m;
+        for (j = m; j < n; ++j) 
+        {
+            if (fabs(MAT(a,n,j,m-1)) > fabs(x)) 
+            {
+                x = MAT(a,n,j,m-1);
+                i = j;
+            }
+        }
+        if (i != m) 
+        {
+            for (j = m-1; j < n; ++j) 
+            {
+                t = MAT(a,n,i,j);
+                MAT(a,n,i,j) = MAT(a,n,m,j);
+                MAT(a,n,m,j) = t;
+            }
+            for (j = 0; j < n; ++j) 
+            {
+                t = MAT(a,n,j,i);
+                MAT(a,n,j,i) = MAT(a,n,j,m);
+                MAT(a,n,j,m) = t;
+            }
+        }
+        if (x != 0) 
+        {
+            for (i = m+1; i < n; ++i) 
+            {
+                y = MAT(a,n,i,m-1);
+                if (y != 0) 
+                {
+                    y /= x;
+                    MAT(a,n,i,m-1) = 0;
+                    for (j = m; j < n; ++j) MAT(a,n,i,j) -= y*MAT(a,n,m,j);
+                    for (j = 0; j < n; ++j) MAT(a,n,j,m) += y*MAT(a,n,j,i);
+                }
+            }
+        }
+    }
+}
+
+bool eigenvalues(const Matrix& a, Matrix& vals)
+{
+    /* eigenvalues of a square real matrix. symmetric matrices
+     * go via tridiagonal QL without vectors and give a real vector in
+     * increasing order, otherwise hessenberg QR gives a complex vector.
+     */
+    if (!a.isSquare()) return false;
+
+    unsigned int n = a._nRows;
+    Mat ad;
+    a.toDense(ad);
+
+    if (n == 1)
+    {
+        Matrix::_create(vals, ad);
+        return true;
+    }
+
+    unsigned int i, j;
+    bool sym = true;
+    for (i = 0; i < n && sym; ++i) 
+        for (j = 0; j < i; ++j) 
+            if (MAT(ad,n,i,j) != MAT(ad,n,j,i)) { sym = false; break; }
+
+    if (sym)
+    {
+        Mat wd(1, n);
+        if (!eigenVectors(ad, n, wd._d, false)) return false;
+
+        // sort increasing
+        for (j = 1; j < n; ++j) 
+        {
+            VALUE t = wd._d[j];
+            for (i = j; i > 0 && wd._d[i-1] > t; --i) wd._d[i] = wd._d[i-1];
+            wd._d[i] = t;
+        }
+        Matrix::_create(vals, wd);
+        return true;
+    }
+
+    balance(ad, n);
+    elmhes(ad, n);
+    Matrix::_create(vals, 1, n, true);   // complex result
+    return hqr(ad, n, vals._a);
+}
+
 bool prootEigen(const Matrix& a, Matrix& rmat)
 {
     // expect a vector of coefficients
@@ -1204,18 +2210,17 @@ bool prootEigen(const Matrix& a, Matrix& rmat)
         // root results
         Matrix::_create(rmat, 1, m, true);   // complex result
     
-        Matrix hess;
-        Matrix::_create(hess, m, m);
+        Mat hess(m, m);
 
         int k, j;
         for (k = 0; k < m; ++k)
         {
-            MAT(hess._a, 0, 0, k) = -VEC(a._a,m-k-1)/VEC(a._a,m);
-            for (j = 1; j < m; ++j) MAT(hess._a, 0, j, k) = 0;
-            if (k != m-1) MAT(hess._a,0,k+1,k) = 1;
+            MAT(hess, m, 0, k) = -VEC(a._a,m-k-1)/VEC(a._a,m);
+            for (j = 1; j < m; ++j) MAT(hess, m, j, k) = 0;
+            if (k != m-1) MAT(hess,m,k+1,k) = 1;
         }
-        balance(hess._a, m);
-        return hqr(hess._a, m, rmat._a);
+        balance(hess, m);
+        return hqr(hess, m, rmat._a);
     }
 }
 
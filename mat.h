@@ -27,15 +27,58 @@
 #include "types.h"
 
 typedef BCD VALUE;
-typedef TermRef Mat;
+
+/* dense row-major matrix of VALUE. all the numerical work is done
+ * on these, conversion to and from array terms happens only at
+ * the Matrix boundary.
+ */
+struct BCDMatrix
+{
+    // Constructors
+    BCDMatrix() : _d(0), _nRows(0), _nCols(0) {}
+    BCDMatrix(unsigned int nRows, unsigned int nCols) : _d(0)
+    { resize(nRows, nCols); }
+
+    // Destructor
+    ~BCDMatrix() { delete [] _d; }
+
+    void resize(unsigned int nRows, unsigned int nCols)
+    {
+        delete [] _d;
+        _nRows = nRows;
+        _nCols = nCols;
+        _d = new VALUE[nRows*nCols];
+    }
+
+    void copy(const BCDMatrix& a)
+    {
+        resize(a._nRows, a._nCols);
+        for (unsigned int i = 0; i < _nRows*_nCols; ++i) _d[i] = a._d[i];
+    }
+
+    VALUE*                      _d;
+    unsigned int                _nRows;
+    unsigned int                _nCols;
+
+private:
+
+    // not copyable, use `copy'
+    BCDMatrix(const BCDMatrix&);
+    BCDMatrix& operator=(const BCDMatrix&);
+};
+
+typedef BCDMatrix Mat;
 typedef TermRef Vec;
 
-#define MAT(_m,_n,_r,_c) FLOAT(ARRAY(ARRAY(_m)->_at(_r))->_at(_c))->v_.asBCD()
-#define VEC(_m,_i) FLOAT(ARRAY(_m)->_at(_i))->v_.asBCD()
+#define MAT(_m,_n,_r,_c) ((_m)._d[(_r)*(_m)._nCols + (_c)])
+
+/* access array terms directly */
+#define AMAT(_m,_r,_c) FLOAT(ARRAY(ARRAY(_m)->_at(_r))->_at(_c))->v_
+#define VEC(_m,_i) FLOAT(ARRAY(_m)->_at(_i))->v_
 #define VECC(_m,_i) COMPLEX(ARRAY(_m)->_at(_i))->cmf_
 
 #define VMAT(_m,_nr,_r,_c) \
-((_nr == 1) ? VEC(_m, _c) : MAT(_m,0,_r,_c)) 
+((_nr == 1) ? VEC(_m, _c) : AMAT(_m,_r,_c)) 
 
 
 /* because we hate templates, the string VALUE, represents the
@@ -61,8 +104,12 @@ struct Matrix
     friend void transpose(const Matrix& a, Matrix& c);
     friend bool invert(const Matrix& b, Matrix& c, bool& singular);
     static void _create(Matrix& a, int nRows, int nCols, bool complex = false);
+    static void _create(Matrix& a, const BCDMatrix& m);
+    void toDense(BCDMatrix& m) const;
 
     bool determinant(VALUE&) const;
+    bool svd(Matrix& u, Matrix& w, Matrix& v) const;
+    bool svdSolve(const Matrix& b, Matrix& x) const;
     bool isSquare() const { return _nRows == _nCols; }
 
     void _init()
@@ -87,6 +134,49 @@ struct Matrix
     TermRef                     _a;     // will be an array
 };
 
+/* LU decomposition with partial pivoting, kept so that repeated
+ * solves against the same matrix do not refactor.
+ */
+struct LUFactorization
+{
+    // Constructors
+    LUFactorization() : _indx(0), _sign(1), _ok(false) {}
+
+    // Destructor
+    ~LUFactorization() { delete [] _indx; }
+
+    bool factor(const Matrix& a);
+    bool solve(const Matrix& b, Matrix& x) const;
+    bool inverse(Matrix& x) const;
+    VALUE determinant() const;
+    bool ok() const { return _ok; }
+
+    // cached factorization of an array term, or 0 if not square
+    static LUFactorization* of(const Matrix& a);
+    static void clearCache();
+
+    BCDMatrix                   _lu;
+    int*                        _indx;
+    int                         _sign;
+    bool                        _ok;
+    TermRef                     _src;   // array term factored
+};
+
 bool prootEigen(const Matrix& a, Matrix& rmat);
 
+/* sparse matrix operations. results are new sparse terms except
+ * where a dense operand is involved.
+ */
+bool sparse(const Matrix& a, TermRef& c);
+bool sparse(const Matrix& ri, const Matrix& ci, const Matrix& v,
+            TermRef& c);
+void dense(const SparseMatrix& a, Matrix& c);
+bool add(const SparseMatrix& a, const SparseMatrix& b, TermRef& c);
+bool mul(const SparseMatrix& a, const SparseMatrix& b, TermRef& c);
+bool mul(const SparseMatrix& a, const Matrix& b, Matrix& c);
+void mul(const SparseMatrix& a, const VALUE& k, TermRef& c);
+void transpose(const SparseMatrix& a, TermRef& c);
+bool div(const Matrix& a, const SparseMatrix& b, Matrix& c);
+bool eigenvalues(const Matrix& a, Matrix& vals);
+
 #endif // __mat_h__
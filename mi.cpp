@@ -42,6 +42,39 @@ extern "C"
 static Big* constZero;
 static Big* constOne;
 
+/* decimal digits per limb, rounded up */
+#define LIMBDIGITS      ((BASEBITS*3 + 9)/10)
+
+/* shift down by a whole limb, in two steps so that it is defined
+ * when the limb is as wide as the type.
+ */
+#define LIMBSHIFT(_u)   (((_u) >> (BASEBITS/2)) >> (BASEBITS/2))
+
+/* numbers of at least this many limbs go to and from decimal by
+ * splitting on a power of ten rather than a digit group at a time.
+ */
+#ifndef RADIX_DC_THRESHOLD
+#define RADIX_DC_THRESHOLD      40
+#endif
+
+/* 10^(4.2^i), made on demand */
+#define POW10_LEVELS            24
+static BIG_THREAD Big* pow10Cache[POW10_LEVELS];
+
+/* odd primes below this are kept in a table, built on first use.
+ * the calculator keeps a small one, 1K resident.
+ */
+#ifndef SMALLPRIME_LIMIT
+#ifdef BIG_CALC
+#define SMALLPRIME_LIMIT        8192
+#else
+#define SMALLPRIME_LIMIT        65536
+#endif
+#endif
+
+static BIG_THREAD unsigned char* smallPrimeGaps;
+static BIG_THREAD unsigned int smallPrimeCount;
+
 Big* one() 
 {
     return constOne;
@@ -86,36 +119,145 @@ void InitBig()
     constOne[1] = 1;
 }
 
-void _destroy(Big* b)
+/** Allocation *******************************************************/
+
+/* limb buffers are handed out in power of two size classes. a
+ * buffer of class `k' is 2^k limbs and carries its class in a
+ * hidden limb in front of the head. freed buffers go onto a free
+ * list for their class, threaded through the buffers themselves,
+ * until BIG_POOL_CACHE bytes are held, after which they go back to
+ * the heap.
+ */
+#ifndef BIG_POOL_CACHE
+#ifdef BIG_CALC
+#define BIG_POOL_CACHE          8192
+#else
+#define BIG_POOL_CACHE          (1L << 22)
+#endif
+#endif
+
+#define POOL_MINCLASS           2
+#define POOL_CLASSES            24
+#define POOL_BYTES(_k)          ((unsigned long)sizeof(Big) << (_k))
+
+static BIG_THREAD Big*          poolFree[POOL_CLASSES];
+static BIG_THREAD unsigned long poolCached;
+static BIG_THREAD BigAllocStats allocStats;
+
+static unsigned int _sizeClass(unsigned int n)
 {
-    delete b;
+    /* smallest class holding `n' limbs */
+    unsigned int k = POOL_MINCLASS;
+    while (((unsigned int)1 << k) < n) ++k;
+    return k;
 }
 
-Big* _create(int s)
+void _destroy(Big* b)
 {
-    Big* b;
-    if (((s<<2)+s) <= Calc::theCalc->_maxDecimalDigits)
+    Big* p = b - 1;
+    unsigned int k = (unsigned int)p[0];
+    unsigned long sz = POOL_BYTES(k);
+
+    allocStats.bytes_ -= sz;
+    if (poolCached + sz <= BIG_POOL_CACHE)
     {
-        b = new Big[s + 1];
-        SET_HEAD(b, 0, s);
+        *(Big**)p = poolFree[k];
+        poolFree[k] = p;
+        poolCached += sz;
     }
     else
-        b = 0;
+        delete [] p;
+}
+
+Big* _create(int s)
+{
+    /* new Big with room for `s' limbs, or 0 if over the digit limit */
+    Big* b = 0;
+    if (s*LIMBDIGITS <= Calc::theCalc->_maxDecimalDigits
+        && (unsigned int)s < TOPBIT)
+    {
+        unsigned int k = _sizeClass(s + 2);  // class limb and head
+        if (k < POOL_CLASSES)
+        {
+            unsigned long sz = POOL_BYTES(k);
+            Big* p = poolFree[k];
+            if (p)
+            {
+                poolFree[k] = *(Big**)p;
+                poolCached -= sz;
+            }
+            else
+            {
+                p = new Big[(unsigned int)1 << k];
+                ++allocStats.heapAllocs_;
+            }
+            
+            ++allocStats.allocs_;
+            allocStats.bytes_ += sz;
+            if (allocStats.bytes_ > allocStats.peakBytes_)
+                allocStats.peakBytes_ = allocStats.bytes_;
 
+            p[0] = k;
+            b = p + 1;
+            SET_HEAD(b, 0, s);
+        }
+    }
     return b;
 }
 
+void bigAllocStats(BigAllocStats* st)
+{
+    *st = allocStats;
+}
+
+void resetBigAllocStats()
+{
+    /* restart the counts, peak from what is live now */
+    allocStats.allocs_ = 0;
+    allocStats.heapAllocs_ = 0;
+    allocStats.peakBytes_ = allocStats.bytes_;
+}
+
 void finishBig()
 {
     _destroy(constZero);
     _destroy(constOne);
+    finishBigThread();
+}
+
+void finishBigThread()
+{
+    /* give back what this thread holds. workers call this before
+     * they exit, the main thread has it from finishBig.
+     */
+    for (int i = 0; i < POW10_LEVELS; ++i)
+    {
+        destroyBig(pow10Cache[i]);
+        pow10Cache[i] = 0;
+    }
+
+    delete [] smallPrimeGaps;
+    smallPrimeGaps = 0;
+    smallPrimeCount = 0;
+
+    /* give back the free lists */
+    for (int k = 0; k < POOL_CLASSES; ++k)
+    {
+        Big* p;
+        while ((p = poolFree[k]) != 0)
+        {
+            poolFree[k] = *(Big**)p;
+            delete [] p;
+        }
+    }
+    poolCached = 0;
 }
 
 unsigned int _bitlength(Big* b)
 {
     /* The size of `b' in binary */
     unsigned int n = DIGITS(b);
-    unsigned int t;
+    Big t;
     unsigned int c;
 
     t = b[n];
@@ -142,6 +284,72 @@ void destroyBig(Big* b)
         _destroy(b);
 }
 
+static Big* _pow10(unsigned int i)
+{
+    if (i >= POW10_LEVELS) return 0;
+    if (!pow10Cache[i])
+    {
+        if (!i) pow10Cache[0] = createBig(10000);
+        else
+        {
+            Big* p = _pow10(i - 1);
+            if (p) pow10Cache[i] = sqrBig(p);
+        }
+    }
+    return pow10Cache[i];
+}
+
+static Big* _parseDecimal(const char* s, unsigned int n)
+{
+    /* value of the `n' decimal digits at `s', 0 if too big.
+     *
+     * long runs are split as hi.10^w + lo with 10^w cached, short
+     * ones are taken four digits at a time.
+     */
+    Big* r;
+    Big* t;
+
+    if (n >= RADIX_DC_THRESHOLD*LIMBDIGITS)
+    {
+        unsigned int i = 0;
+        while ((8 << (i + 1)) <= n) ++i;
+
+        unsigned int w = 4 << i;
+        Big* pw = _pow10(i);
+        if (pw)
+        {
+            Big* hi = _parseDecimal(s, n - w);
+            Big* lo = hi ? _parseDecimal(s + n - w, w) : 0;
+            t = lo ? mulBig(hi, pw) : 0;
+            r = t ? addBig(t, lo) : 0;
+            destroyBig(hi);
+            destroyBig(lo);
+            destroyBig(t);
+            return r;
+        }
+    }
+        
+    r = constZero;
+    while (n)
+    {
+        unsigned int k = (n & 3) ? (n & 3) : 4;
+        unsigned int v = 0;
+        int m = 1;
+
+        n -= k;
+        while (k--)
+        {
+            v = v*10 + (*s++ - '0');
+            m *= 10;
+        }
+
+        t = mulint(r, m); destroyBig(r);
+        r = addint(t, v); destroyBig(t);
+        if (!r) break; // too large
+    }
+    return r;
+}
+
 Big* parseBig(const char** sp)
 {
     /* Expect `*sp' points to -?[0-9]+ or -?[0]*[Xb][0-9A-F]+ */
@@ -174,6 +382,20 @@ Big* parseBig(const char** sp)
         ++s;
     }
 
+    if (base == 10)
+    {
+        /* decimal, convert the whole run of digits */
+        const char* e = s;
+        while (u_isdigit(*e)) ++e;
+
+        if (e != s)
+        {
+            r = _parseDecimal(s, e - s);
+            if (!r) return 0; // bail number got too large
+            s = e;
+        }
+    }
+
     while (*s) 
     {
         Big* t;
@@ -205,30 +427,43 @@ Big* parseBig(const char** sp)
     return r;
 }
 
+static Big* _createu(unsigned long u)
+{
+    /* new Big from unsigned int, as many limbs as it needs */
+    Big* b;
+    unsigned long h = u;
+    unsigned int n = 0;
+
+    do
+    {
+        ++n;
+        h = LIMBSHIFT(h);
+    } while (h);
+
+    b = _create(n);
+    if (b)
+    {
+        for (unsigned int i = 1; i <= n; ++i)
+        {
+            b[i] = (Big)u;
+            u = LIMBSHIFT(u);
+        }
+    }
+    return b;
+}
+
 Big* createBig(long v)
 {
     /* Big from signed int */
     Big* b;
-    long l, h;
     int neg;
 
     if (!v) return constZero;
     if (v == 1) return constOne;
 
     neg = (v < 0);
-    if (neg) v = -v;
-    
-    h = v >> BASEBITS;
-    l = v & (BBASE-1);
-
-    if (h) {
-        b = _create(2);
-        b[2] = (Big)h;
-    }
-    else b = _create(1);
-    b[1] = (Big)l;
-
-    if (neg) NEGATEBIT(b);
+    b = _createu(neg ? 0UL - (unsigned long)v : (unsigned long)v);
+    if (b && neg) NEGATEBIT(b);
 
     return b;
 }
@@ -237,23 +472,9 @@ Big* createBigu(unsigned long u)
 {
     /* Big from unsigned int */
 
-    Big* b;
-    long l, h;
-
     if (!u) return constZero;
     if (u == 1) return constOne;
-
-    h = u >> BASEBITS;
-    l = u & (BBASE-1);
-
-    if (h) 
-    {
-        b = _create(2);
-        b[2] = (Big)h;
-    }
-    else b = _create(1);
-    b[1] = (Big)l;
-    return b;
+    return _createu(u);
 }
 
 Big* addu(Big* a, Big* b)
@@ -263,7 +484,7 @@ Big* addu(Big* a, Big* b)
     Big* r;
     Big* r0;
 
-    unsigned long v, c;
+    BigDouble v, c;
     unsigned int n;
     unsigned int m;
 
@@ -285,20 +506,20 @@ Big* addu(Big* a, Big* b)
         while (n) 
         {
             --n;
-            v = *++a + *++b + c;
+            v = (BigDouble)*++a + *++b + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
     
         while (m) 
         {
             --m;
-            v = *++a + c;
+            v = (BigDouble)*++a + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
 
-        if (c) *++r = c;
+        if (c) *++r = (Big)c;
         else --*r0;
     }
     return r0;
@@ -319,9 +540,9 @@ Big* addint(Big* a, unsigned int b)
     Big* r;
     Big* r0;
 
-    unsigned long v;
+    BigDouble v;
     unsigned int n;
-    unsigned int c;
+    BigDouble c;
 
     if (!a) return 0;
 
@@ -336,10 +557,10 @@ Big* addint(Big* a, unsigned int b)
             --n;
             v = *++a + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
     
-        if (c) *++r = c;
+        if (c) *++r = (Big)c;
         else --*r0;
     }
     return r0;
@@ -351,7 +572,7 @@ Big* subint(Big* a, unsigned int b)
 
     Big* r;
     Big* r0;
-    unsigned long v, c;
+    BigDouble v, c;
     unsigned int n;
 
     if (!a) return 0;
@@ -363,12 +584,12 @@ Big* subint(Big* a, unsigned int b)
         r = r0;
         v = BBASE + *++a - b;
         c = v >> BASEBITS;
-        *++r = v;
+        *++r = (Big)v;
         while (--n) 
         {
             v = (BBASE-1) + *++a + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
 
         while (!*r && r-1 != r0) 
@@ -387,7 +608,7 @@ Big* subu(Big* a, Big* b)
     Big* r;
     Big* r0;
 
-    unsigned long v, c;
+    BigDouble v, c;
     unsigned int n;
     unsigned int m;
 
@@ -404,14 +625,14 @@ Big* subu(Big* a, Big* b)
             --n;
             v = (BBASE-1) + *++a - *++b + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
         while (m) 
         {
             --m;
             v = (BBASE-1) + *++a + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
 
         while (!*r) 
@@ -464,8 +685,11 @@ int compareu(Big* a, Big* b)
         a += la;
         b += la;
         do {
-            d = *a - *b;
-            if (d) break;
+            if (*a != *b) 
+            {
+                d = *a > *b ? 1 : -1;
+                break;
+            }
             --a;
             --b;
         } while (--la);
@@ -559,45 +783,38 @@ Big* negateBig(Big* b)
 
 Big* lshiftn(Big* b, unsigned int n)
 {
-    /* b*2^n */
+    /* b*2^n, whole limbs then the remaining bits in one pass */
     Big* r;
-    unsigned int d;
+    unsigned int d, s, nb, i;
+    Big c;
 
-    if (!n || !b) return copyBig(b);
+    if (!n || !b || ISZERO(b)) return copyBig(b);
 
-    d = n & (BASEBITS-1);
-    if (d) 
-    {
-        r = lshiftBig(b, true);  // DUP
-        while (r && --d) 
-            r = lshiftBig(r, false);
+    d = n >> BASEBITSBITS;
+    s = n & (BASEBITS-1);
+    nb = DIGITS(b);
 
-    }
-    else r = copyBig(b);
-    
+    // bits carried out of the top limb
+    c = s ? (Big)(b[nb] >> (BASEBITS - s)) : 0;
+
+    r = _create(nb + d + (c != 0));
     if (r)
     {
-        d = n >> BASEBITSBITS;
-        if (d) 
+        for (i = 1; i <= d; ++i) r[i] = 0;
+        
+        c = 0;
+        for (i = 1; i <= nb; ++i)
         {
-            unsigned int c = DIGITS(r);
-            Big* t = _create(c + d);
-            if (t)
+            Big v = b[i];
+            if (s)
             {
-                int i;
-                for (i = 1; i <= d; ++i)
-                    t[i] = 0;
-                
-                int j = 1;
-                while (j <= c)
-                    t[i++] = r[j++];
-                        
-                SET_SIGNOF(t, b);
+                r[i + d] = (Big)(v << s) | c;
+                c = (Big)(v >> (BASEBITS - s));
             }
-
-            destroyBig(r);
-            r = t;
+            else r[i + d] = v;
         }
+        if (c) r[nb + d + 1] = c;
+        SET_SIGNOF(r, b);
     }
     return r;
 }
@@ -612,14 +829,14 @@ Big* lshiftBig(Big* b, int dup)
     Big* r0;
     Big* r;
     Big* b0 = b;
-    unsigned long v;
+    BigDouble v;
     unsigned int c;
 
     if (!b || ISZERO(b)) return b;
     if (b == constOne) return createBig(2);
     
     n = DIGITS(b);
-    c = (b[n] & (1<<(BASEBITS-1))) != 0;  // top bit set?
+    c = (b[n] & TOPBIT) != 0;  // top bit set?
 
     if (dup || c) 
     {
@@ -636,9 +853,9 @@ Big* lshiftBig(Big* b, int dup)
         while (n) 
         {
             n--;
-            v = (*++b << 1) + c;
-            c = v >> BASEBITS;
-            *++r = v;
+            v = ((BigDouble)*++b << 1) + c;
+            c = (unsigned int)(v >> BASEBITS);
+            *++r = (Big)v;
         }
         if (c) 
             *++r = c;
@@ -686,7 +903,7 @@ Big* mulint(Big* a, int b)
     /* multiply `a' by b where b < BBASE */
     int neg;
     unsigned int n;
-    unsigned long c, v;
+    BigDouble c, v;
     Big* r0;
     Big* r;
 
@@ -708,26 +925,290 @@ Big* mulint(Big* a, int b)
         while (n) 
         {
             n--;
-            v = *++a * b + c;
+            v = (BigDouble)*++a * (unsigned int)b + c;
             c = v >> BASEBITS;
-            *++r = v;
+            *++r = (Big)v;
         }
     
-        if (c) *++r = c;
+        if (c) *++r = (Big)c;
         else --*r0;
         SET_SIGNIF(r0, neg);
     }
     return r0;
 }
 
+/* operands of at least this many limbs use karatsuba.
+ * tuned on the schoolbook loops below.
+ */
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD     24
+#endif
+
+static void _mulRaw(const Big* a, unsigned int la,
+                    const Big* b, unsigned int lb, Big* r)
+{
+    /* schoolbook r = a * b on bare limbs, least significant first.
+     * `r' gets la + lb limbs.
+     */
+    BigDouble c, v;
+    unsigned int j;
+
+    for (j = 0; j < lb; ++j) r[j] = 0;
+            
+    while (la) 
+    {
+        la--;
+        c = 0;
+        if (*a)
+        {
+            for (j = 0; j < lb; ++j) 
+            {
+                v = (BigDouble)*a * b[j] + r[j] + c;
+                c = v >> BASEBITS;
+                r[j] = (Big)v;
+            }
+        }
+        r[lb] = (Big)c;
+        ++a;
+        ++r;
+    }
+}
+
+static void _sqrRaw(const Big* a, unsigned int t, Big* r)
+{
+    /* schoolbook r = a^2 on bare limbs, `r' gets 2t limbs. 
+     * cross products are formed once and doubled.
+     */
+    unsigned int t2 = t<<1;
+    unsigned int i, j;
+    for (i = 0; i < t2; ++i) r[i] = 0;
+
+    const Big* ai = a;
+    for (i = 0; i < t; ++i)
+    {
+        BigDouble c;
+        BigDouble c2;
+        Big* rij = r + i + i;
+        BigDouble uv = *rij + (BigDouble)(*ai)*(*ai);
+        *rij = (Big)uv;
+        c = uv >> BASEBITS;
+        for (j = i+1; j < t; ++j)
+        {
+            //uv = r[i+j] + a[j]*(*ai)*2 + c;
+            c2 = 0;
+            uv = (BigDouble)a[j]*(*ai);
+            if (uv >> (2*BASEBITS - 1))
+            {
+                // will carry when doubled.
+                c2 = BBASE;
+            }
+            uv <<= 1;
+            c += *++rij;
+            uv += c;
+            if (uv < c)
+            {
+                // carried
+                c2 += BBASE;
+            }
+                    
+            *rij = (Big)uv;
+            c = (uv >> BASEBITS) + c2;
+        }
+
+        c += *++rij;
+        *rij = (Big)c;
+        c >>= BASEBITS;
+        if (c)
+            *++rij = (Big)c;
+
+        ++ai;
+    }
+}
+
+static void _addInto(Big* r, unsigned int rn, const Big* a, unsigned int an)
+{
+    /* r += a, carrying up through `rn' limbs of `r' */
+    BigDouble c = 0;
+    unsigned int i;
+    for (i = 0; i < an; ++i)
+    {
+        c += (BigDouble)r[i] + a[i];
+        r[i] = (Big)c;
+        c >>= BASEBITS;
+    }
+    for (; c && i < rn; ++i)
+    {
+        c += r[i];
+        r[i] = (Big)c;
+        c >>= BASEBITS;
+    }
+}
+
+static void _subInto(Big* r, unsigned int rn, const Big* a, unsigned int an)
+{
+    /* r -= a, where r >= a */
+    BigDouble v;
+    unsigned int c = 0;
+    unsigned int i;
+    for (i = 0; i < an; ++i)
+    {
+        v = (BigDouble)r[i] - a[i] - c;
+        r[i] = (Big)v;
+        c = (unsigned int)(v >> BASEBITS) & 1;
+    }
+    for (; c && i < rn; ++i)
+    {
+        c = r[i] == 0;
+        --r[i];
+    }
+}
+
+static bool _absDiff(Big* r, const Big* x, unsigned int n,
+                     const Big* y, unsigned int m)
+{
+    /* r = |x - y| over `n' limbs, where `y' has m <= n limbs.
+     * return true if x < y.
+     */
+    unsigned int i;
+    int s = 0;
+    for (i = m; i < n; ++i) if (x[i]) { s = 1; break; }
+    i = m;
+    while (!s && i)
+    {
+        --i;
+        if (x[i] != y[i]) s = x[i] > y[i] ? 1 : -1;
+    }
+
+    if (s >= 0)
+    {
+        for (i = 0; i < n; ++i) r[i] = x[i];
+        _subInto(r, n, y, m);
+    }
+    else
+    {
+        for (i = 0; i < m; ++i) r[i] = y[i];
+        for (; i < n; ++i) r[i] = 0;
+        _subInto(r, n, x, n);
+    }
+    return s < 0;
+}
+
+static unsigned int _karatsubaSpace(unsigned int n)
+{
+    /* workspace limbs needed by _karatsuba for size `n' */
+    if (n < KARATSUBA_THRESHOLD) return 0;
+    unsigned int hi = n - (n>>1);
+    unsigned int w = _karatsubaSpace(hi);
+    if (w < 2*hi + 1) w = 2*hi + 1;
+    return 4*hi + w;
+}
+
+static void _karatsuba(const Big* a, const Big* b, unsigned int n,
+                       Big* r, Big* ws)
+{
+    /* r = a * b for `n' limb operands, `r' gets 2n limbs.
+     * with a = a1.B^h + a0, b = b1.B^h + b0
+     * a.b = z2.B^2h + (z0 + z2 - (a1-a0)(b1-b0)).B^h + z0
+     * where z0 = a0.b0 and z2 = a1.b1
+     *
+     * if `b' is `a' we are squaring.
+     */
+    bool sq = a == b;
+    if (n < KARATSUBA_THRESHOLD)
+    {
+        if (sq) _sqrRaw(a, n, r);
+        else _mulRaw(a, n, b, n, r);
+        return;
+    }
+
+    unsigned int h = n>>1;
+    unsigned int hi = n - h;
+    Big* da = ws;
+    Big* db = da + hi;
+    Big* t = db + hi;
+    Big* ws2 = t + 2*hi;
+
+    bool neg = _absDiff(da, a + h, hi, a, h);
+    if (sq)
+    {
+        // (a1-a0)^2 is never negative
+        db = da;
+        neg = false;
+    }
+    else neg ^= _absDiff(db, b + h, hi, b, h);
+
+    _karatsuba(a, sq ? a : b, h, r, ws2);
+    _karatsuba(a + h, sq ? a + h : b + h, hi, r + 2*h, ws2);
+    _karatsuba(da, db, hi, t, ws2);
+
+    // middle term, z0 + z2 -/+ t
+    Big* mid = ws2;
+    unsigned int i;
+    for (i = 0; i < 2*h; ++i) mid[i] = r[i];
+    for (; i <= 2*hi; ++i) mid[i] = 0;
+    _addInto(mid, 2*hi + 1, r + 2*h, 2*hi);
+    if (neg) _addInto(mid, 2*hi + 1, t, 2*hi);
+    else _subInto(mid, 2*hi + 1, t, 2*hi);
+
+    _addInto(r + h, 2*n - h, mid, 2*hi + 1);
+}
+
+static void _mulLimbs(const Big* a, unsigned int la,
+                      const Big* b, unsigned int lb, Big* r)
+{
+    /* r = a * b, `r' gets la + lb limbs */
+    if (la < lb)
+    {
+        const Big* t = a; a = b; b = t;
+        unsigned int l = la; la = lb; lb = l;
+    }
+
+    if (lb < KARATSUBA_THRESHOLD)
+    {
+        _mulRaw(a, la, b, lb, r);
+        return;
+    }
+
+    /* cut the longer into pieces the size of the shorter */
+    Big* ws = new Big[2*lb + _karatsubaSpace(lb)];
+    Big* t = ws + _karatsubaSpace(lb);
+    unsigned int i;
+    for (i = 0; i < la + lb; ++i) r[i] = 0;
+
+    unsigned int off = 0;
+    while (off + lb <= la)
+    {
+        _karatsuba(a + off, b, lb, t, ws);
+        _addInto(r + off, la + lb - off, t, 2*lb);
+        off += lb;
+    }
+
+    if (off < la)
+    {
+        unsigned int m = la - off;
+        _mulLimbs(a + off, m, b, lb, t);
+        _addInto(r + off, la + lb - off, t, m + lb);
+    }
+    delete [] ws;
+}
+
+static void _sqrLimbs(const Big* a, unsigned int t, Big* r)
+{
+    /* r = a^2, `r' gets 2t limbs */
+    if (t < KARATSUBA_THRESHOLD) _sqrRaw(a, t, r);
+    else
+    {
+        Big* ws = new Big[_karatsubaSpace(t)];
+        _karatsuba(a, a, t, r, ws);
+        delete [] ws;
+    }
+}
+
 Big* mulBig(Big* a, Big* b)
 {
     /* a * b, signed */
     Big* r0;
-    Big* r;
     int neg;
-    unsigned long c, v;
-    unsigned int j;
 
     r0 = 0;
     if (a && b)
@@ -741,30 +1222,8 @@ Big* mulBig(Big* a, Big* b)
         r0 = _create(la + lb);
         if (r0)
         {
-            r = r0;
-            for (j = 1; j <= lb; ++j) r[j] = 0;
-            
-            while (la) 
-            {
-                la--;
-                c = 0;
-                if (*++a)
-                {
-                    for (j = 1; j <= lb; ++j) 
-                    {
-                        v = *a * b[j] + r[j] + c;
-                        c = v >> BASEBITS;
-                        r[j] = v;
-                    }
-                }
-                else
-                    j = lb+1;
-
-                r[j] = c;
-                ++r;
-            }
-
-            if (!r[lb]) --*r0;
+            _mulLimbs(a + 1, la, b + 1, lb, r0 + 1);
+            if (!r0[la + lb]) --*r0;
             SET_SIGNIF(r0, neg);
         }
     }
@@ -783,52 +1242,10 @@ Big* sqrBig(Big* a)
         r = _create(t2);
         if (r)
         {
-            int i, j;
-            for (i = 1; i <= t2; ++i) r[i] = 0;
-
-            Big* ai = a + 1;
-            for (i = 0; i < t; ++i)
-            {
-                unsigned int c;
-                unsigned int c2;
-                Big* rij = r + i + i + 1;
-                unsigned int uv = *rij + (*ai)*(*ai);
-                *rij = uv;
-                c = uv >> BASEBITS;
-                for (j = i+2; j <= t; ++j)
-                {
-                    //uv = r[i+j] + a[j]*(*ai)*2 + c;
-                    c2 = 0;
-                    uv = a[j]*(*ai);
-                    if (uv & 0x80000000)
-                    {
-                        // will carry when doubled.
-                        c2 = 1<<BASEBITS;
-                    }
-                    uv <<= 1;
-                    c += *++rij;
-                    uv += c;
-                    if (uv < c)
-                    {
-                        // carried
-                        c2 += 1<<BASEBITS;
-                    }
-                    
-                    *rij = uv;
-                    c = (uv >> BASEBITS) + c2;
-                }
-
-                c += *++rij;
-                *rij = c;
-                c >>= BASEBITS;
-                if (c)
-                    *++rij = c;
-
-                ++ai;
-            }
-            if (!r[t2]) --*r;
-        }
-    }
+            _sqrLimbs(a + 1, t, r + 1);
+            if (!r[t2]) --*r;
+        }
+    }
 
 #if 0
     {
@@ -868,41 +1285,48 @@ Big* mulBigMod(Big* a, Big* b, Big* m)
 
 Big* rshiftn(Big* b, unsigned int n)
 {
-    Big* a = copyBig(b);
-    if (n && a)
+    /* b/2^n truncated, drop whole limbs then shift the rest */
+    Big* r;
+    unsigned int d, s, m, i;
+
+    if (!n || !b) return copyBig(b);
+
+    d = n >> BASEBITSBITS;
+    s = n & (BASEBITS-1);
+    if (d >= DIGITS(b)) return constZero;
+
+    m = DIGITS(b) - d;
+    r = _create(m);
+    if (r)
     {
-        int d = n & (BASEBITS-1);
-        while (d)
+        const Big* p = b + d;
+        for (i = 1; i <= m; ++i)
         {
-            --d;
-            rshiftBig(a);
+            Big v = p[i];
+            if (s)
+            {
+                v >>= s;
+                if (i < m) v |= (Big)(p[i+1] << (BASEBITS - s));
+            }
+            r[i] = v;
         }
 
-        d = n >> BASEBITSBITS;
-        if (d)
+        while (m > 1 && !r[m]) --m;
+        if (m == 1 && !r[1])
         {
-            // drop `d' digits
-            int c = DIGITS(a);
-            int neg = NEGATIVE(a) != 0;
-            int i = 1 + d;
-            int j = 1;
-            c -= d;
-            SET_HEAD(a, neg, c);
-            while (c)
-            {
-                --c;
-                a[j++] = a[i++];
-            }
+            destroyBig(r);
+            r = constZero;
         }
+        else SET_HEAD(r, SIGNBIT(b), m);
     }
-    return a;
+    return r;
 }
 
 Big* rshiftBig(Big* b)
 {
     /* DESTRUCTIVE, halve b*/
     unsigned int n;
-    unsigned long c, v;
+    Big c, v;
     Big* p;
 
     if (!b || ISZERO(b)) return b;
@@ -925,13 +1349,273 @@ Big* rshiftBig(Big* b)
     return b;
 }
 
-Big* divBig(Big* a,Big* b,Big** rem)
+/* divisors and quotients both of at least this many limbs divide
+ * by newton reciprocal instead of algorithm D.
+ */
+#ifndef DIVNEWTON_THRESHOLD
+#define DIVNEWTON_THRESHOLD     300
+#endif
+
+static Big* _limbs(Big* a, unsigned int from, unsigned int n)
+{
+    /* new positive Big from `n' limbs of `a' above limb `from' */
+    unsigned int d = DIGITS(a);
+    unsigned int i;
+    Big* r;
+
+    if (from >= d) return constZero;
+    if (from + n > d) n = d - from;
+    while (n > 1 && !a[from + n]) --n;
+    if (n == 1 && !a[from + 1]) return constZero;
+
+    r = _create(n);
+    if (r)
+        for (i = 1; i <= n; ++i) r[i] = a[from + i];
+    return r;
+}
+
+static Big* _fixQuotient(Big* a, Big* b, Big* q, Big** rem)
+{
+    /* `q' is within a few of a/b, all positive. step it to the
+     * true quotient and put the remainder in `rem'. consumes `q'.
+     */
+    Big* t = mulBig(q, b);
+    Big* r = subBig(a, t);
+    destroyBig(t);
+
+    while (r && q && SIGNBIT(r))
+    {
+        t = addBig(r, b); destroyBig(r); r = t;
+        t = subint(q, 1U); destroyBig(q); q = t;
+    }
+    
+    while (r && q && compareu(r, b) >= 0)
+    {
+        t = subBig(r, b); destroyBig(r); r = t;
+        t = addint(q, 1U); destroyBig(q); q = t;
+    }
+
+    if (!r || !q)
+    {
+        destroyBig(r);
+        destroyBig(q);
+        return 0;
+    }
+    *rem = r;
+    return q;
+}
+
+static Big* _divKnuth(Big* a, Big* b, Big** rem);
+
+static Big* _recip(Big* v, unsigned int k)
+{
+    /* about B^2k/v for `v' of `k' limbs, 0 if too big.
+     *
+     * short ones exactly. otherwise from Xh = B^2h/vh, the
+     * reciprocal of the top h = k/2+2 limbs, one newton step,
+     * X = Xh.B^(k-h) + Xh.e/B^2h where e = B^(k+h) - v.Xh,
+     * leaves X within a few units.
+     *
+     * h is only below k for k above 4, so those go exactly whatever
+     * the threshold, or a low one would recurse for ever.
+     */
+    Big* x;
+    Big* t;
+    Big* e;
+    Big* p;
+    unsigned int h = (k >> 1) + 2;
+
+    if (k < DIVNEWTON_THRESHOLD || h >= k)
+    {
+        p = lshiftn(constOne, 2*k*BASEBITS);
+        x = p ? _divKnuth(p, v, 0) : 0;
+        destroyBig(p);
+        return x;
+    }
+
+    unsigned int sh = (k - h)*BASEBITS;
+
+    t = rshiftn(v, sh);
+    x = t ? _recip(t, h) : 0;
+    destroyBig(t);
+    if (!x) return 0;
+    
+    p = lshiftn(constOne, (k + h)*BASEBITS);
+    t = p ? mulBig(v, x) : 0;
+    e = t ? subBig(p, t) : 0;
+    destroyBig(t);
+    destroyBig(p);
+
+    t = e ? mulBig(x, e) : 0;
+    destroyBig(e);
+    e = t ? rshiftn(t, 2*h*BASEBITS) : 0;
+    destroyBig(t);
+
+    t = e ? lshiftn(x, sh) : 0;
+    destroyBig(x);
+    x = t ? addBig(t, e) : 0;
+    destroyBig(t);
+    destroyBig(e);
+    return x;
+}
+
+static Big* _mulRecip(Big* c, Big* x, unsigned int k)
+{
+    /* c.x/B^2k for `c' below B^2k, within a few of c/v when
+     * x is about B^2k/v. only the top k+1 limbs of `c' matter.
+     */
+    unsigned int s = DIGITS(c) > k + 1 ? k - 1 : 0;
+    Big* ct = s ? rshiftn(c, s*BASEBITS) : c;
+    Big* t = ct ? mulBig(ct, x) : 0;
+    Big* q = t ? rshiftn(t, (2*k - s)*BASEBITS) : 0;
+    if (ct != c) destroyBig(ct);
+    destroyBig(t);
+    return q;
+}
+
+static Big* _divNewton(Big* a, Big* b, Big** rem)
+{
+    /* a / b and remainder, both positive and a much longer than b.
+     * answer 0 if anything gets too big.
+     *
+     * with the reciprocal X = B^2k/b, the quotient of anything
+     * below B^2k is estimated as a product. long quotients are
+     * taken k limbs at a time from the top, short ones only need
+     * the top m+2 limbs of a and b.
+     */
+    unsigned int nm = DIGITS(a);
+    unsigned int n = DIGITS(b);
+    unsigned int m = nm - n;
+    unsigned int k = n;
+    unsigned int t = 0;
+    unsigned int l, c, i;
+    Big* x;
+    Big* q;
+    Big* quo;
+    Big* cur;
+    Big* r = 0;
+    bool done = false;
+
+    if (m + 2 < n)
+    {
+        k = m + 2;
+        t = n - k;
+    }
+
+    cur = t ? _limbs(b, t, k) : b;
+    x = cur ? _recip(cur, k) : 0;
+    if (cur != b) destroyBig(cur);
+    if (!x) return 0;
+
+    if (t)
+    {
+        /* short quotient */
+        cur = _limbs(a, t, nm - t);
+        q = cur ? _mulRecip(cur, x, k) : 0;
+        destroyBig(cur);
+        destroyBig(x);
+        return q ? _fixQuotient(a, b, q, rem) : 0;
+    }
+
+    quo = _create(m + 1);
+    if (!quo)
+    {
+        destroyBig(x);
+        return 0;
+    }
+    for (i = 1; i <= m + 1; ++i) quo[i] = 0;
+
+    /* `l' limbs of `a' are below the current piece */
+    l = m > k ? m - k : 0;
+    cur = _limbs(a, l, nm - l);
+    while (cur)
+    {
+        q = _mulRecip(cur, x, k);
+        q = q ? _fixQuotient(cur, b, q, &r) : 0;
+        destroyBig(cur);
+        cur = 0;
+        if (!q) break;
+
+        for (i = 1; i <= DIGITS(q); ++i) quo[l + i] = q[i];
+        destroyBig(q);
+
+        if (!l)
+        {
+            *rem = r;
+            done = true;
+            break;
+        }
+
+        /* bring down the next piece */
+        c = l < k ? l : k;
+        l -= c;
+        q = lshiftn(r, c*BASEBITS);
+        destroyBig(r);
+        r = _limbs(a, l, c);
+        cur = (q && r) ? addBig(q, r) : 0;
+        destroyBig(q);
+        destroyBig(r);
+        r = 0;
+    }
+    destroyBig(x);
+
+    if (!done)
+    {
+        // bailed
+        destroyBig(quo);
+        return 0;
+    }
+
+    while (DIGITS(quo) > 1 && !quo[DIGITS(quo)]) --*quo;
+    return quo;
+}
+
+Big* divBig(Big* a, Big* b, Big** rem)
+{
+    /* a / b, if (rem) *rem = remainder, signed.
+     *
+     * newton when both the divisor and quotient are long, falling
+     * back to algorithm D if that runs out of room.
+     */
+    if (a && b && DIGITS(b) >= DIVNEWTON_THRESHOLD
+        && DIGITS(a) >= DIGITS(b) + DIVNEWTON_THRESHOLD)
+    {
+        Big* ua = a;
+        Big* ub = b;
+        Big* r = 0;
+        Big* quo = 0;
+
+        // work on magnitudes
+        if (SIGNBIT(a) && (ua = copyBig(a)) != 0) NEGATEBIT(ua);
+        if (SIGNBIT(b) && (ub = copyBig(b)) != 0) NEGATEBIT(ub);
+
+        if (ua && ub) quo = _divNewton(ua, ub, &r);
+        if (ua != a) destroyBig(ua);
+        if (ub != b) destroyBig(ub);
+
+        if (quo)
+        {
+            if (SIGNBIT(a) ^ SIGNBIT(b)) quo = negateBig(quo);
+            if (rem)
+            {
+                if (SIGNBIT(a)) r = negateBig(r);
+                *rem = r;
+            }
+            else destroyBig(r);
+            return quo;
+        }
+    }
+    return _divKnuth(a, b, rem);
+}
+
+Big* _divKnuth(Big* a, Big* b, Big** rem)
 {
     /* a / b, if (rem) *rem = remainder, signed.
      *
      * USE Knuth Algorithm D.
      */
-    unsigned int nm,n,m,d;
+    unsigned int nm,n,m;
+    Big d;
     Big* u;
     Big* v;
     Big* quo;
@@ -940,12 +1624,11 @@ Big* divBig(Big* a,Big* b,Big** rem)
     Big* dr;
     Big* dp;
     Big* dp2;
-    int carry;
-    int ts;
-    unsigned int tu;
-    unsigned int q;
+    BigDouble carry;
+    BigDouble tu;
+    BigDouble q;
     int agb;
-    Big* r;
+    Big* r = 0;
 
     if (rem) *rem = 0;
 
@@ -1006,10 +1689,10 @@ Big* divBig(Big* a,Big* b,Big** rem)
         while (l--) 
         {
             tu = (carry<<BASEBITS) + (*dp--);
-            *dr = tu/d;
-            carry = tu - (*dr--)*d;
+            *dr = (Big)(tu/d);
+            carry = tu - (*dr--)*(BigDouble)d;
         }
-        if (rem) r[1] = carry;
+        if (rem) r[1] = (Big)carry;
     }
     else 
     {
@@ -1031,7 +1714,7 @@ Big* divBig(Big* a,Big* b,Big** rem)
             return 0;
         }
 
-        d = BBASE/(b[n]+1);
+        d = (Big)(BBASE/((BigDouble)b[n]+1));
 
         dp = a + 1;
         l = nm;
@@ -1039,13 +1722,13 @@ Big* divBig(Big* a,Big* b,Big** rem)
         dr = u + 1;
         while (l)
         {
-            tu = (*dp++)*d + carry;
+            tu = (BigDouble)(*dp++)*d + carry;
             carry = tu>>BASEBITS;
-            *dr++ = tu;
+            *dr++ = (Big)tu;
             l--;
         }
 
-        *dr = carry;
+        *dr = (Big)carry;
 
         dp = b + 1;
         dr = v + 1;
@@ -1053,9 +1736,9 @@ Big* divBig(Big* a,Big* b,Big** rem)
         carry = 0;
         while (l) 
         {
-            tu = (*dp++)*d + carry;
+            tu = (BigDouble)(*dp++)*d + carry;
             carry = tu >> BASEBITS;
-            *dr++ = tu;
+            *dr++ = (Big)tu;
             l--;
         }
 
@@ -1071,14 +1754,14 @@ Big* divBig(Big* a,Big* b,Big** rem)
              * normq <- normq - 1
              */               
 
-            tu = (u[nm-j+1]<<BASEBITS)+u[nm-j];
+            tu = ((BigDouble)u[nm-j+1]<<BASEBITS)+u[nm-j];
             if (u[nm-j+1] == v[n]) q = BBASE-1;
             else q = tu/v[n];
 
             for (;;)
             {
-                unsigned int ta = v[n-1]*q;
-                unsigned int tb = tu-q*v[n];
+                BigDouble ta = v[n-1]*q;
+                BigDouble tb = tu-q*v[n];
                 if (tb>>BASEBITS) break;
 
                 if (ta > ((tb<<BASEBITS) + u[nm-j-1])) q--;
@@ -1094,55 +1777,30 @@ Big* divBig(Big* a,Big* b,Big** rem)
             /* multiply & subtract,
              *
              * (UjU(j+1)... U(j+n)) <- (Uj..U(j+n)) - normq * (V1.. Vn)
+             *
+             * `carry' is the high part of the product, `borrow' 
+             * from the subtraction.
              */
             dp = &u[nm-n-j+1];
             l = n;
             dp2 = v + 1;
             carry = 0;
+            Big borrow = 0;
             while (l)
             {
-                unsigned int t1 = (*dp2++)*q;
-                unsigned int cm = -carry;
-
-                unsigned int t2 = t1 + cm;
-                int ov1 = 0;
-                int ov2 = 0;
-
-                if (t2 < t1 || t2 < cm) {
-                    ov1 = 1;
-                }
-
-                if (*dp < t2) ov2 = 1;
-
-                ts =  (*dp) - t2;
-
-                if (ov1 || ov2) {
-
-                    if (!ov1) {
-                        carry = (ts>>BASEBITS);
-                        carry |= 0xffff0000;
-                    }
-                    else {
-                        if (ov2) {
-                            carry = (ts>>BASEBITS);
-                            carry -= BBASE;
-                        }
-                        else {
-                            ts = -ts;
-                            carry = (ts>>BASEBITS);
-                        }
-                    }
-                }
-                else carry = 0;
-                *dp++ = ts;
+                tu = (*dp2++)*q + carry;
+                carry = tu >> BASEBITS;
+                Big t = (Big)tu;
+                Big s = *dp - t;
+                Big s2 = s - borrow;
+                borrow = (*dp < t) | (s < borrow);
+                *dp++ = s2;
                 l--;
             }
-            ts = *dp + carry;
-            if (ts < 0) 
-                carry = 1;
-
-            else carry = 0;
-            *dp = ts;
+            Big t = (Big)carry;
+            Big s = *dp - t;
+            carry = (*dp < t) | (s < borrow);
+            *dp = s - borrow;
 
             /* any 'carry' left over is the net borrow 
              *
@@ -1150,7 +1808,7 @@ Big* divBig(Big* a,Big* b,Big** rem)
              * Qj <- normq
              * if (step_d4 >= 0 ) continue
              */
-            quo[m-j+1] = q;
+            quo[m-j+1] = (Big)q;
             if (carry) 
             {
                 quo[m-j+1]--;
@@ -1160,13 +1818,11 @@ Big* divBig(Big* a,Big* b,Big** rem)
                 carry = 0;
                 while (l--) 
                 {
-                    tu = (*dp) + (*dp2++) + carry;
+                    tu = (BigDouble)(*dp) + (*dp2++) + carry;
                     carry = tu>>BASEBITS;
-                    *dp++ = tu;
+                    *dp++ = (Big)tu;
                 }
-                tu = (*dp) + carry;
-                tu -= BBASE;
-                *dp = tu;
+                *dp += (Big)carry; // discard final carry
             }
         }
     
@@ -1181,9 +1837,9 @@ Big* divBig(Big* a,Big* b,Big** rem)
             dp = &u[nm - m];
             dr = r + n;
             while (l--) {
-                ts = (carry<<BASEBITS) + (*dp--);
-                *dr = ts/d;
-                carry = ts - (*dr--) * d;
+                tu = (carry<<BASEBITS) + (*dp--);
+                *dr = (Big)(tu/d);
+                carry = tu - (*dr--) * (BigDouble)d;
             }
         }
 
@@ -1231,46 +1887,139 @@ Big* divBig(Big* a,Big* b,Big** rem)
     return quo;
 }
 
+static Big _topLimb(Big* x, unsigned int sh)
+{
+    /* BASEBITS-1 bits of |x| starting at bit `sh' */
+    unsigned int i = (sh >> BASEBITSBITS) + 1;
+    BigDouble w = 0;
+
+    if (i <= DIGITS(x)) w = x[i];
+    if (i < DIGITS(x)) w |= (BigDouble)x[i+1] << BASEBITS;
+    return (Big)(w >> (sh & (BASEBITS-1))) & (TOPBIT-1);
+}
+
+static Big* _combine(Big* u, Big* v, BigSigned p, BigSigned q)
+{
+    /* p|u| + q|v|, where the result is known to lie in [0,|u|]
+     * and |p|,|q| < TOPBIT.
+     */
+    unsigned int n = DIGITS(u);
+    unsigned int m = DIGITS(v);
+    unsigned int i;
+    BigSigned c = 0;
+    Big* r = _create(n);
+
+    if (r)
+    {
+        for (i = 1; i <= n; ++i)
+        {
+            c += p*(BigSigned)u[i];
+            if (i <= m) c += q*(BigSigned)v[i];
+            r[i] = (Big)c;
+            c >>= BASEBITS;
+        }
+        while (n > 1 && !r[n]) --n;
+        SET_HEAD(r, 0, n);
+    }
+    return r;
+}
+
+static Big _gcdLimb(Big a, Big b)
+{
+    /* binary gcd of two limbs */
+    unsigned int k = 0;
+    Big t;
+
+    if (!a) return b;
+    if (!b) return a;
+
+    while (!((a | b) & 1)) { a >>= 1; b >>= 1; ++k; }
+    while (!(a & 1)) a >>= 1;
+    do
+    {
+        while (!(b & 1)) b >>= 1;
+        if (a > b) { t = a; a = b; b = t; }
+        b -= a;
+    } while (b);
+    return (Big)(a << k);
+}
+
 Big* gcdBigu(Big* a, Big* b)
 {
-    /* (|a|,|b|), |a| >= |b|, b != 0 */
+    /* (|a|,|b|), |a| >= |b|, b != 0
+     *
+     * lehmer's method. the euclid quotients of the leading bits
+     * of u and v are collected into the cofactors A, B, C & D
+     * and applied to the whole numbers in one pass. when the
+     * leading bits give no quotient, take one division step.
+     * once v is a single limb, finish with a binary gcd.
+     */
 
     Big* r;
-    Big* u = 0;
+    Big* t;
+    Big* u;
     Big* v;
+    BigSigned x, y, q, w;
+    BigSigned A, B, C, D;
+    BigDouble m;
+    unsigned int i;
 
     if (ISONE(b)) return constOne;
 
-    destroyBig(divBig(a, b, &r));
-    if (r)
+    u = copyBig(a);
+    v = copyBig(b);
+    while (u && v && DIGITS(v) > 1)
     {
-        u = b;
-        v = r;
+        i = _bitlength(u) - (BASEBITS-1);
+        x = _topLimb(u, i);
+        y = _topLimb(v, i);
+        A = 1; B = 0; C = 0; D = 1;
+        while (y + C && y + D)
+        {
+            q = (x + A)/(y + C);
+            if (q != (x + B)/(y + D)) break;
 
-        if (ISZERO(v)) u = copyBig(u);
-        else 
+            w = A - q*C; A = C; C = w;
+            w = B - q*D; B = D; D = w;
+            w = x - q*y; x = y; y = w;
+        }
+
+        if (!B)
         {
             destroyBig(divBig(u, v, &r));
-            u = 0;
-            if (r)   // else destroy v and bail
-            {
-                u = v;
-                v = r;
+            destroyBig(u);
+            u = v;
+            v = r;
+        }
+        else
+        {
+            t = _combine(u, v, A, B);
+            r = _combine(u, v, C, D);
+            destroyBig(u);
+            destroyBig(v);
+            u = t;
+            v = r;
+        }
+    }
 
-                while (!ISZERO(v)) 
-                {
-                    destroyBig(divBig(u, v, &r));
-                    destroyBig(u); u = 0;
-                    if (!r)
-                        break;  // destroy v and bail.
+    if (!v)
+    {
+        destroyBig(u);
+        return 0;
+    }
 
-                    u = v;
-                    v = r;
-                }
-            }
-        }
-        destroyBig(v);
+    if (u && !ISZERO(v))
+    {
+        /* u mod v, then both on limbs */
+        m = 0;
+        for (i = DIGITS(u); i > 0; --i)
+            m = ((m << BASEBITS) | u[i]) % v[1];
+
+        destroyBig(u);
+        u = _create(1);
+        if (u) u[1] = _gcdLimb(v[1], (Big)m);
     }
+    destroyBig(v);
     return u;
 }
 
@@ -1328,56 +2077,99 @@ unsigned int log10(Big* b)
     return l;
 }
 
+static char* _decimalSmall(Big* b, char* p, unsigned int w)
+{
+    /* digits of `b' least significant first at `p', four at a time,
+     * zero filled to `w'. answer the end.
+     */
+    Big* tens = _pow10(0);
+    Big* n;
+    Big* m;
+    Big* r;
+    char* p0 = p;
+
+    n = b;
+    for (;;) {
+        int done;
+        unsigned int t, d;
+
+        m = divBig(n, tens, &r);
+            
+        if (n != b) destroyBig(n);
+        n = m;
+
+        done = ISZERO(n);
+            
+        d = r[1];
+        t = d/1000; d -= t*1000;
+        p[3] = t + '0';
+        t = d/100; d -= t*100;
+        p[2] = t + '0';
+        t = d/10; d -= t*10;
+        p[1] = t + '0';
+        p[0] = d + '0';
+            
+        p += 4;
+        while (done && p[-1] == '0' && (unsigned int)(p - p0) > w) --p;
+            
+        destroyBig(r);
+
+        if (done) break;
+    } 
+    destroyBig(n);
+
+    while ((unsigned int)(p - p0) < w) *p++ = '0';
+    return p;
+}
+
+static char* _decimal(Big* b, char* p, unsigned int w)
+{
+    /* as _decimalSmall, but long numbers are split on the cached
+     * power of ten nearest their square root and the halves done
+     * separately.
+     */
+    unsigned int n = DIGITS(b);
+
+    // a single limb does not split, however low the threshold
+    if (n >= RADIX_DC_THRESHOLD && n > 1)
+    {
+        unsigned int i = 0;
+        Big* pw;
+        while ((pw = _pow10(i + 1)) != 0 && 2*DIGITS(pw) <= n + 1) ++i;
+
+        Big* r;
+        Big* q = divBig(b, _pow10(i), &r);
+        if (q && r)
+        {
+            unsigned int d = 4 << i;
+            p = _decimal(r, p, d);
+            p = _decimal(q, p, w > d ? w - d : 0);
+            destroyBig(q);
+            destroyBig(r);
+            return p;
+        }
+        destroyBig(q);
+        destroyBig(r);
+    }
+    return _decimalSmall(b, p, w);
+}
+
 void asString(Big* b, streamFn sf, void* stream)
 {
     /* convert b to decimal string */
     
     if (ISZERO(b)) (*sf)(stream, '0');
     else {
-        Big* tens = createBig(10000);
-        Big* n;
-        Big* m;
-        Big* r;
         unsigned int dl;
         char* p;
         char* buf;
         
         dl = _decimalLength(b) + 4;
-        p = buf = (char*)malloc(dl);
+        buf = (char*)malloc(dl);
         
         if (NEGATIVE(b)) (*sf)(stream, '-');
 
-        n = b;
-        for (;;) {
-            int done;
-            unsigned int t, d;
-
-            m = divBig(n, tens, &r);
-            
-            if (n != b) destroyBig(n);
-            n = m;
-
-            done = ISZERO(n);
-            
-            d = r[1];
-            t = d/1000; d -= t*1000;
-            p[3] = t + '0';
-            t = d/100; d -= t*100;
-            p[2] = t + '0';
-            t = d/10; d -= t*10;
-            p[1] = t + '0';
-            p[0] = d + '0';
-            
-            p += 4;
-            while (done && p[-1] == '0') --p;
-            
-            destroyBig(r);
-
-            if (done) break;
-        } 
-        destroyBig(n);
-        destroyBig(tens);
-
+        p = _decimal(b, buf, 0);
 
         do {
             (*sf)(stream, *--p);
@@ -1443,6 +2235,19 @@ Big* powerBigMod(Big* b, Big* n0, Big* m)
     
     if (ISZERO(n0)) return constOne;
     if (ISONE(n0)) return copyBig(b);
+
+    if (ISODD(m) && !SIGNBIT(b))
+    {
+        /* odd modulus, go via montgomery */
+        BigMont mc;
+        if (initBigMont(&mc, m))
+        {
+            t = powerBigMont(&mc, b, n0);
+            y = t ? fromBigMont(&mc, t) : 0;
+            destroyBig(t);
+            return y;
+        }
+    }
     
     y = 0;
     z = b;
@@ -1472,48 +2277,337 @@ Big* powerBigMod(Big* b, Big* n0, Big* m)
             }
         }
 
-        if (z != b) destroyBig(z);
-        destroyBig(n);
+        if (z != b) destroyBig(z);
+        destroyBig(n);
+    }
+    return y;
+}
+
+Big* powerBigintMod(Big* b, unsigned int n, Big* m)
+{
+    /* b^ n (mod m), b < m */
+    Big* y;
+    Big* z;
+    Big* t;
+    
+    if (!n) return constOne;
+    if (n == 1) return copyBig(b);
+
+    if (b && m && ISODD(m) && !SIGNBIT(b))
+    {
+        /* odd modulus, go via montgomery */
+        BigMont mc;
+        if (initBigMont(&mc, m))
+        {
+            Big* e = createBigu(n);
+            t = e ? powerBigMont(&mc, b, e) : 0;
+            y = t ? fromBigMont(&mc, t) : 0;
+            destroyBig(t);
+            destroyBig(e);
+            return y;
+        }
+    }
+    
+    y = constOne;
+    z = b;
+
+    for (;;) 
+    {
+        unsigned int c = n&1;
+        n >>= 1;
+        if (c) 
+        {
+            t = mulBigMod(z, y, m);
+            destroyBig(y);
+            y = t;
+            if (!y || !n) break;
+        }
+
+        t = mulBigMod(z, z, m);
+        if (z != b) destroyBig(z);
+        z = t;
+        if (!z)
+        {
+            destroyBig(y); y = 0;
+            break;
+        }
+    }
+
+    if (z != b) destroyBig(z);
+    return y;
+}
+
+/** Montgomery *******************************************************/
+
+/* residues mod odd `m' are held as aR mod m with R = B^n, n the
+ * limbs of m. a product then reduces by n single limb steps rather
+ * than a division. a BigMont is set up once per modulus and kept.
+ */
+
+/* largest sliding window, the table holds 2^(k-1) odd powers */
+#define MONT_MAXWINDOW          5
+
+bool initBigMont(BigMont* mc, Big* m)
+{
+    /* set up `mc' for `m', which must be odd and > 1 */
+    unsigned int n, i;
+    BigDouble x;
+    Big* p;
+    Big* r = 0;
+
+    finishBigMont(mc);
+    if (!m || !ISODD(m) || ISONE(m) || SIGNBIT(m)) return false;
+
+    /* -1/m mod B by newton. m is its own inverse to 3 bits and
+     * each step doubles that.
+     */
+    x = m[1];
+    for (i = 3; i < BASEBITS; i <<= 1)
+        x = (Big)(x*(2 - (BigDouble)m[1]*x));
+
+    n = DIGITS(m);
+    p = lshiftn(constOne, 2*n*BASEBITS);
+    if (p) destroyBig(divBig(p, m, &r));
+    destroyBig(p);
+    if (!r) return false;
+
+    mc->m_ = copyBig(m);
+    mc->n_ = n;
+    mc->minv_ = (Big)(0 - x);
+    mc->r2_ = r;
+    /* product limbs, then for karatsuba a padded operand and
+     * its workspace.
+     */
+    i = _karatsubaSpace(n);
+    mc->ws_ = new Big[2*n + 1 + (i ? n + i : 0)];
+
+    if (!mc->m_ || !mc->ws_)
+    {
+        finishBigMont(mc);
+        return false;
+    }
+    return true;
+}
+
+void finishBigMont(BigMont* mc)
+{
+    destroyBig(mc->m_);
+    destroyBig(mc->r2_);
+    delete [] mc->ws_;
+    mc->m_ = 0;
+    mc->r2_ = 0;
+    mc->ws_ = 0;
+}
+
+static Big* _redc(BigMont* mc, Big* t)
+{
+    /* t/R mod m as a new Big, for `t' of 2n+1 bare limbs below mR.
+     * `t' is overwritten.
+     */
+    unsigned int n = mc->n_;
+    const Big* m = mc->m_ + 1;
+    unsigned int i, j;
+    BigDouble c, v;
+
+    for (i = 0; i < n; ++i)
+    {
+        // add the multiple of m that clears limb i
+        Big u = (Big)(t[i]*(BigDouble)mc->minv_);
+        c = 0;
+        for (j = 0; j < n; ++j)
+        {
+            v = (BigDouble)u*m[j] + t[i + j] + c;
+            t[i + j] = (Big)v;
+            c = v >> BASEBITS;
+        }
+        for (j += i; c; ++j)
+        {
+            v = (BigDouble)t[j] + c;
+            t[j] = (Big)v;
+            c = v >> BASEBITS;
+        }
+    }
+
+    /* t/R is now the top n+1 limbs, below 2m */
+    Big* r = t + n;
+    bool big = r[n] != 0;
+    if (!big)
+    {
+        for (i = n; i > 0 && r[i-1] == m[i-1]; --i) ;
+        big = !i || r[i-1] > m[i-1];
+    }
+    if (big) _subInto(r, n + 1, m, n);
+
+    while (n > 1 && !r[n-1]) --n;
+    if (n == 1 && !r[0]) return constZero;
+
+    Big* res = _create(n);
+    if (res)
+        for (i = 0; i < n; ++i) res[i + 1] = r[i];
+    return res;
+}
+
+Big* mulBigMont(BigMont* mc, Big* a, Big* b)
+{
+    /* a.b/R mod m, for residues `a' and `b' */
+    unsigned int la, lb, i;
+    unsigned int n = mc->n_;
+    Big* t = mc->ws_;
+
+    if (!a || !b) return 0;
+
+    la = DIGITS(a);
+    lb = DIGITS(b);
+    if (la < KARATSUBA_THRESHOLD || lb < KARATSUBA_THRESHOLD)
+    {
+        // schoolbook, no workspace needed
+        if (a == b) _sqrLimbs(a + 1, la, t);
+        else _mulLimbs(a + 1, la, b + 1, lb, t);
+    }
+    else
+    {
+        /* karatsuba in our own workspace rather than the heap.
+         * the shorter operand is padded to the length of the longer.
+         */
+        const Big* x = a + 1;
+        const Big* y = b + 1;
+        Big* p = t + 2*n + 1;
+        if (la != lb)
+        {
+            if (la < lb) { x = y; y = a + 1; i = la; la = lb; lb = i; }
+            for (i = 0; i < lb; ++i) p[i] = y[i];
+            for (; i < la; ++i) p[i] = 0;
+            y = p;
+            lb = la;
+        }
+        _karatsuba(x, y, la, t, p + n);
+    }
+    for (i = la + lb; i <= 2*n; ++i) t[i] = 0;
+    return _redc(mc, t);
+}
+
+Big* toBigMont(BigMont* mc, Big* a)
+{
+    /* aR mod m, `a' any integer */
+    Big* r = 0;
+    Big* x;
+
+    if (!a) return 0;
+    if (SIGNBIT(a) || compareu(a, mc->m_) >= 0)
+    {
+        destroyBig(divBig(a, mc->m_, &r));
+        if (r && SIGNBIT(r))
+        {
+            Big* t = addBig(r, mc->m_);
+            destroyBig(r);
+            r = t;
+        }
+        if (!r) return 0;
     }
-    return y;
+    x = mulBigMont(mc, r ? r : a, mc->r2_);
+    destroyBig(r);
+    return x;
 }
 
-Big* powerBigintMod(Big* b, unsigned int n, Big* m)
+Big* fromBigMont(BigMont* mc, Big* a)
 {
-    /* b^ n (mod m), b < m */
-    Big* y;
-    Big* z;
+    /* a/R mod m, back from a residue */
+    unsigned int la, i;
+    Big* t = mc->ws_;
+
+    if (!a) return 0;
+
+    la = DIGITS(a);
+    for (i = 0; i < la; ++i) t[i] = a[i + 1];
+    for (; i <= 2*mc->n_; ++i) t[i] = 0;
+    return _redc(mc, t);
+}
+
+#define BITOF(_e, _i)   (((_e)[1 + ((_i) >> BASEBITSBITS)] >> ((_i) & (BASEBITS-1))) & 1)
+
+Big* powerBigMont(BigMont* mc, Big* b, Big* e)
+{
+    /* residue of b^e, e >= 0.
+     *
+     * left to right sliding window. the odd powers b, b^3 ..
+     * b^(2^k-1) are made first, then each run of up to k bits
+     * ending in a one costs its squarings and one multiply.
+     */
+    Big* tab[1 << (MONT_MAXWINDOW-1)];
+    Big* y = 0;
     Big* t;
+    unsigned int nb, k, nt, i, w;
+    int bi, j, l;
+    bool ok;
+
+    if (!b || !e) return 0;
+    if (ISZERO(e)) return toBigMont(mc, constOne);
+
+    nb = _bitlength(e);
+    if (nb <= 8) k = 1;
+    else if (nb <= 24) k = 2;
+    else if (nb <= 80) k = 3;
+    else if (nb <= 240) k = 4;
+    else k = MONT_MAXWINDOW;
+
+    nt = 1 << (k-1);
+    for (i = 0; i < nt; ++i) tab[i] = 0;
     
-    if (!n) return constOne;
-    if (n == 1) return copyBig(b);
+    tab[0] = toBigMont(mc, b);
+    if (nt > 1 && tab[0])
+    {
+        Big* b2 = mulBigMont(mc, tab[0], tab[0]);
+        for (i = 1; i < nt && b2 && tab[i-1]; ++i)
+            tab[i] = mulBigMont(mc, tab[i-1], b2);
+        destroyBig(b2);
+    }
+    ok = tab[nt-1] != 0;
     
-    y = constOne;
-    z = b;
-
-    for (;;) 
+    bi = nb - 1;
+    while (ok && bi >= 0)
     {
-        unsigned int c = n&1;
-        n >>= 1;
-        if (c) 
+        if (!BITOF(e, bi))
         {
-            t = mulBigMod(z, y, m);
+            t = mulBigMont(mc, y, y);
             destroyBig(y);
             y = t;
-            if (!y || !n) break;
+            ok = y != 0;
+            --bi;
+            continue;
         }
 
-        t = mulBigMod(z, z, m);
-        if (z != b) destroyBig(z);
-        z = t;
-        if (!z)
+        /* longest window from `bi' ending in a one */
+        j = bi + 1 - (int)k;
+        if (j < 0) j = 0;
+        while (!BITOF(e, j)) ++j;
+
+        w = 0;
+        for (l = bi; l >= j; --l) w = (w << 1) | BITOF(e, l);
+
+        if (y)
         {
-            destroyBig(y); y = 0;
-            break;
+            for (l = j; l <= bi && y; ++l)
+            {
+                t = mulBigMont(mc, y, y);
+                destroyBig(y);
+                y = t;
+            }
+            t = y ? mulBigMont(mc, y, tab[w >> 1]) : 0;
+            destroyBig(y);
+            y = t;
         }
+        else y = copyBig(tab[w >> 1]);
+
+        ok = y != 0;
+        bi = j - 1;
     }
 
-    if (z != b) destroyBig(z);
+    for (i = 0; i < nt; ++i) destroyBig(tab[i]);
+    if (!ok)
+    {
+        destroyBig(y);
+        y = 0;
+    }
     return y;
 }
 
@@ -1554,23 +2648,31 @@ Big* rootBig(Big* n)
     return x;
 }
 
-int bigAsInt(Big* b)
+static bool _asUint(Big* b, unsigned int* u)
 {
+    /* magnitude of `b' if it fits 32 bits */
     unsigned int d = DIGITS(b);
+    if (d > (32 + BASEBITS - 1)/BASEBITS) return false;
+
+    BigDouble v = 0;
+    while (d) v = (v << (BASEBITS/2) << (BASEBITS/2)) + b[d--];
+    if (v >> 16 >> 16) return false;
+    *u = (unsigned int)v;
+    return true;
+}
+
+int bigAsInt(Big* b)
+{
     int v;
+    unsigned int u;
     
-    if (d > 2)
+    if (!_asUint(b, &u))
     {
         if (NEGATIVE(b)) v = 0x80000000;
         else v = 0x7fffffff;
     }
     else
     {
-        unsigned int u = b[1];
-        if (d > 1)
-        {
-            u += ((unsigned int)b[2]) << BASEBITS;
-        }
         if (!NEGATIVE(b))
         {
             if (u > 0x7fffffff) u = 0x7fffffff;
@@ -1589,19 +2691,10 @@ int bigAsInt(Big* b)
 
 unsigned int bigAsUint(Big* b)
 {
-    unsigned int d = DIGITS(b);
     unsigned int u;
     
     if (NEGATIVE(b)) u = 0;
-    else 
-    {
-        if (d > 2) u = 0xffffffff;
-        else
-        {
-            u = b[1];
-            if (d > 1) u += ((unsigned int)b[2]) << BASEBITS;
-        }
-    }
+    else if (!_asUint(b, &u)) u = 0xffffffff;
     return u;
 }
 
@@ -1695,6 +2788,81 @@ bool copyFrac(BigFrac* f, BigFrac* c)
     return _roundFrac(c);
 }
 
+/* when non-zero, results of add, sub, mul & div are left unreduced
+ * until either part exceeds this many bits. the trigger should sit
+ * well above the reduced size of the values, otherwise every step
+ * pays for a full reduction.
+ */
+static BIG_THREAD unsigned int fracLazyBits;
+
+/* the trigger in use. a reduction that leaves a part above it
+ * doubles it, so that values already in lowest terms, such as
+ * continued fraction convergents, do not pay for one every step.
+ */
+static BIG_THREAD unsigned int fracLazyAt;
+
+/* set once any result has been left unreduced. from then on values
+ * are reduced where lowest terms matter, for display, comparison
+ * and wherever an integer is needed.
+ */
+static BIG_THREAD bool fracUnreduced;
+
+unsigned int setFracLazy(unsigned int bits)
+{
+    /* set the lazy trigger, return the old one */
+    unsigned int old = fracLazyBits;
+    fracLazyBits = bits;
+    fracLazyAt = bits;
+    return old;
+}
+
+unsigned int fracLazy()
+{
+    return fracLazyBits;
+}
+
+bool normFrac(BigFrac* f)
+{
+    /* reduce to lowest terms */
+    if (!FRACOK(f)) return false;
+    return _roundFrac(_normFrac(f));
+}
+
+static void _lowFrac(const BigFrac* f)
+{
+    /* reduce `f' in place if it might not be in lowest terms.
+     * the value is unchanged, so it may be const to the caller.
+     */
+    if (fracUnreduced && FRACOK(f) && !ISONE(f->y_))
+        normFrac((BigFrac*)f);
+}
+
+bool isIntFrac(BigFrac* f)
+{
+    /* is `f' an integer */
+    _lowFrac(f);
+    return ISONE(f->y_);
+}
+
+static bool _lazyFrac(Big* x, Big* y, BigFrac* c)
+{
+    /* c = x/y without reducing, unless over the lazy trigger */
+    c->x_ = x;
+    c->y_ = y;
+    if (!_roundFrac(c)) return false;
+
+    if (_bitlength(c->x_) > fracLazyAt || _bitlength(c->y_) > fracLazyAt)
+    {
+        if (!normFrac(c)) return false;
+        while ((_bitlength(c->x_) > fracLazyAt ||
+                _bitlength(c->y_) > fracLazyAt) && fracLazyAt < 0x40000000)
+            fracLazyAt <<= 1;
+    }
+
+    if (!ISONE(c->y_)) fracUnreduced = true;
+    return true;
+}
+
 static bool addsubFrac(BigFrac* u,BigFrac* v, Big* (*addsubfn)(Big*,Big*),
                        BigFrac* c)
 {
@@ -1707,6 +2875,16 @@ static bool addsubFrac(BigFrac* u,BigFrac* v, Big* (*addsubfn)(Big*,Big*),
     Big* x = 0;
     Big* y = 0;
 
+    if (fracLazyBits)
+    {
+        t1 = mulBig(u->x_, v->y_);
+        t2 = mulBig(u->y_, v->x_);
+        x = (*addsubfn)(t1, t2);
+        destroyBig(t1);
+        destroyBig(t2);
+        return _lazyFrac(x, mulBig(u->y_, v->y_), c);
+    }
+
     d1 = gcdBig(u->y_, v->y_);
     if (d1)
     {
@@ -1776,6 +2954,9 @@ bool mulFrac(BigFrac* u,BigFrac* v, BigFrac* c)
     Big* x;
     Big* y;
 
+    if (fracLazyBits)
+        return _lazyFrac(mulBig(u->x_, v->x_), mulBig(u->y_, v->y_), c);
+
     d1 = gcdBig(u->x_, v->y_);
     d2 = gcdBig(u->y_, v->x_);
     
@@ -1812,6 +2993,9 @@ bool divFrac(BigFrac* u,BigFrac* v, BigFrac* c)
 
     if (v->x_ && !ISZERO(v->x_)) 
     {
+        if (fracLazyBits)
+            return _lazyFrac(mulBig(u->x_, v->y_), mulBig(u->y_, v->x_), c);
+
         d1 = gcdBig(u->x_, v->x_);
         d2 = gcdBig(u->y_, v->y_);
     
@@ -1931,6 +3115,8 @@ bool powerFrac(BigFrac* u, BigFrac* v, BigFrac* c)
     // u^v, v integral or 1/n 
 
     bool res;
+    _lowFrac(u);
+    _lowFrac(v);
     if (ISZERO(u->x_))
     {
         c->x_ = constOne;
@@ -1976,7 +3162,8 @@ void asStringFrac(const BigFrac* f, streamFn sf, void* stream)
     /* convert frac to decimal ratio */
 
     if (!f->x_) return; 
-    
+
+    _lowFrac(f);
     if (ISONE(f->y_)) {
         asString(f->x_, sf, stream);
     }
@@ -2009,6 +3196,7 @@ void asStringFrac(const BigFrac* f, streamFn sf, void* stream)
 
 bool rootFrac(BigFrac* n, BigFrac* c)
 {
+    _lowFrac(n);
     c->x_ = rootBig(n->x_);
     if (ISONE(n->y_)) 
         c->y_ = constOne;
@@ -2021,7 +3209,7 @@ bool rootFrac(BigFrac* n, BigFrac* c)
 bool nRootFrac(BigFrac* a, unsigned int k, BigFrac* c)
 {
     bool res = false;
-    if (ISONE(a->y_))
+    if (isIntFrac(a))
     {
         BigInt n(a->x_);
         BigInt rt = nRoot(n, k);
@@ -2061,6 +3249,8 @@ unsigned int fracAsUint(BigFrac* f)
 bool sameFrac(BigFrac* a, BigFrac* b)
 {
     /* are two Fracs the same numerator AND denominator */
+    _lowFrac(a);
+    _lowFrac(b);
     return !compare(a->x_, b->x_) && !compare(a->y_, b->y_);
 }
 
@@ -2095,9 +3285,61 @@ bool parallelFrac(BigFrac* a, BigFrac* b, BigFrac* c)
 
 /************ Algorithms ***************************************/
 
+unsigned int smallPrimes(const unsigned char** gaps)
+{
+    /* the odd primes below SMALLPRIME_LIMIT as half the gap from
+     * the one before, starting from 1. so 3 is 1, 5 is 1, 7 is 1,
+     * 11 is 2 and so on. return the count, 0 if out of memory.
+     */
+    if (!smallPrimeGaps)
+    {
+        /* sieve the odd numbers, one bit each */
+        unsigned int nb = SMALLPRIME_LIMIT/2;
+        unsigned char* bits = new unsigned char[(nb + 7)/8];
+        unsigned int i, j, n, last;
+
+        if (!bits) return 0;
+        memset(bits, 0, (nb + 7)/8);
+
+        /* bit i is 2i+1 */
+        for (i = 1; (2*i+1)*(2*i+1) < SMALLPRIME_LIMIT; ++i)
+        {
+            if (bits[i >> 3] & (1 << (i & 7))) continue;
+            for (j = (2*i+1)*(2*i+1)/2; j < nb; j += 2*i+1)
+                bits[j >> 3] |= 1 << (j & 7);
+        }
+
+        n = 0;
+        for (i = 1; i < nb; ++i)
+            if (!(bits[i >> 3] & (1 << (i & 7)))) ++n;
+
+        smallPrimeGaps = new unsigned char[n];
+        if (smallPrimeGaps)
+        {
+            n = 0;
+            last = 0;
+            for (i = 1; i < nb; ++i)
+            {
+                if (!(bits[i >> 3] & (1 << (i & 7))))
+                {
+                    smallPrimeGaps[n++] = (unsigned char)(i - last);
+                    last = i;
+                }
+            }
+            smallPrimeCount = n;
+        }
+        delete [] bits;
+    }
+
+    *gaps = smallPrimeGaps;
+    return smallPrimeCount;
+}
+
 static unsigned int smallFactorMethod(Big* n, unsigned int limit)
 {
-    // use algorithm published in HPCC Datafile V28n5 p26, December 2009.
+    // trial divide by the table of small primes, then continue
+    // with the algorithm published in HPCC Datafile V28n5 p26,
+    // December 2009.
 
     // ASSUME n > 1
     // if we reach `limit' return value > limit
@@ -2105,73 +3347,68 @@ static unsigned int smallFactorMethod(Big* n, unsigned int limit)
     // are we even?
     if (!ISODD(n)) return 2;
 
-    // check 3, 5, 7, 11, 13 directly
+    const unsigned char* gaps;
+    unsigned int np = smallPrimes(&gaps);
+    unsigned int d = 1;
+    unsigned int k;
     int i;
     int cc = 0;
-    for (i = 3; i <= 13; i += 2)
+
+    for (k = 0; k < np; ++k)
     {
-        Big* r;
-        int z;
-        Big* d;
+        d += (unsigned int)gaps[k] << 1;
+        if (d > limit) return d;
+        if (!modBig(n, d)) return d;
 
-        if (i == 9) continue; 
-        if (i > limit) return i;
+        cc = (cc + 1) & 0xfff;
+        if (!cc && EscapeKeyPressed()) return 0; // fail
+    }
 
-        d = createBigu(i);
-        destroyBig(divBig(n, d, &r));
-        if (!r) return 0; // fail
-        z = ISZERO(r);
-        destroyBig(r);
-        destroyBig(d);
-        if (z) return i;
+    if (!np)
+    {
+        // no table, check 3, 5, 7, 11, 13 directly
+        for (d = 3; d <= 13; d += 2)
+        {
+            if (d == 9) continue; 
+            if (d > limit) return d;
+            if (!modBig(n, d)) return d;
+        }
+        d = 17;
+    }
+    else d += 2;
 
+    if (d > limit) return d;
 
-    }
-    
-    // now start the trial shifter 
-    // first divide the number by 16's. we will need a slot
-    // for every 16.
-    int nd = (_bitlength(n) + 3)/4; // number of 16s
+    // now start the trial shifter at d, from the digits of n in
+    // base d. there are no more of these than hex digits.
+    int nd = (_bitlength(n) + 3)/4;
     int* div = new int[nd];
-    unsigned int d = 0;
     int j;
 
     if (div)
     {
-        int* pp = div;
-        for (i = 1; i <= DIGITS(n); ++i)
+        Big* t = copyBig(n);
+        Big* b = createBigu(d);
+        Big* r;
+        Big* q;
+
+        nd = 0;
+        while (t && !ISZERO(t))
         {
-            int v = n[i];
-            bool on = i < DIGITS(n);
-            for (j = 0; j < 4; ++j)
-            {
-                if (v || on) { *pp++ = v & 0xf; v >>= 4; }
-            }
+            q = divBig(t, b, &r);
+            destroyBig(t);
+            t = q;
+            div[nd++] = bigAsUint(r);
+            destroyBig(r);
         }
-
-#if 0
-        // debug print
-        for (i = 0; i < nd; ++i)
-            printf("%d ", div[i]);
-        printf("\n");
-#endif
-
-        // slide to 17
-        d = 17;
-        for (i = nd-2; i >= 0; --i)
+        destroyBig(b);
+        if (!t)
         {
-            for (j = i; j < nd-1; ++j)
-            {
-                if ((div[j] -= div[j+1]) < 0)
-                {
-                    div[j] += d;
-                    --div[j+1];
-                }
-            }
-            if (!div[j]) --nd;
+            delete [] div;
+            return 0; // fail
         }
+        destroyBig(t);
 
-        // not divisible by 17
         // generic slide by 2
         while (div[0])
         {
@@ -2206,7 +3443,189 @@ static unsigned int smallFactorMethod(Big* n, unsigned int limit)
     return d;
 }
 
-static unsigned long randomNumber;
+/* pollard rho takes a gcd once every this many steps */
+#ifndef RHO_BATCH
+#define RHO_BATCH               100
+#endif
+
+/* steps of rho that factor tries before lenstra */
+#ifndef RHO_TRIALS
+#define RHO_TRIALS              (1L<<14)
+#endif
+
+static Big* _rhoNext(BigMont* mc, Big* x, unsigned int pw, Big* c)
+{
+    /* DESTRUCTIVE, x^pw + c on residues */
+    Big* y = 0;
+    Big* t;
+    unsigned int i;
+
+    if (x)
+    {
+        y = mulBigMont(mc, x, x);
+        for (i = 2; y && i < pw; ++i)
+        {
+            t = mulBigMont(mc, y, x);
+            destroyBig(y);
+            y = t;
+        }
+        destroyBig(x);
+    }
+
+    if (y)
+    {
+        t = addBig(y, c);
+        destroyBig(y);
+        y = t;
+        if (y && compare(y, mc->m_) >= 0)
+        {
+            t = subBig(y, mc->m_);
+            destroyBig(y);
+            y = t;
+        }
+    }
+    return y;
+}
+
+static Big* _rhoWalk(BigMont* mc, unsigned int pw, Big* c,
+                     unsigned int limit, unsigned int* used)
+{
+    /* one walk from 2 by brent's method. the |x-y| are
+     * multiplied together and tried with one gcd for each
+     * RHO_BATCH steps. when that gives n, go back over the
+     * batch a step at a time.
+     * return a proper factor or 0.
+     */
+    Big* x = 0;
+    Big* y = createBigu(2);
+    Big* ys = 0;
+    Big* q = constOne;
+    Big* g = 0;
+    Big* t;
+    Big* d;
+    unsigned int r = 1;
+    unsigned int k, i, m;
+    int cc = 0;
+    int esc = 0;
+
+    while (!g && y && !esc && *used < limit)
+    {
+        /* x stays at the start of each power of two */
+        destroyBig(x);
+        x = y;
+        y = copyBig(x);
+        for (i = 0; y && i < r; ++i)
+            y = _rhoNext(mc, y, pw, c);
+        *used += r;
+
+        for (k = 0; y && k < r && !g; k += m)
+        {
+            destroyBig(ys);
+            ys = copyBig(y);
+            m = r - k < RHO_BATCH ? r - k : RHO_BATCH;
+            for (i = 0; y && q && i < m; ++i)
+            {
+                y = _rhoNext(mc, y, pw, c);
+                if (!y) break;
+
+                d = subBig(x, y);
+                if (d && SIGNBIT(d)) d = negateBig(d);
+                t = d ? mulBigMont(mc, q, d) : 0;
+                destroyBig(d);
+                destroyBig(q);
+                q = t;
+            }
+            *used += m;
+
+            if (!y || !q) break; // bail
+
+            t = gcdBig(q, mc->m_);
+            if (t && !ISONE(t)) g = t;
+            else destroyBig(t);
+
+            cc = (cc + 1) & 0x3f;
+            if (!cc && (esc = EscapeKeyPressed()) != 0) break;
+            if (*used >= limit) break;
+        }
+        r <<= 1;
+    }
+
+    if (g && !compare(g, mc->m_))
+    {
+        /* overshot, step from the start of the batch */
+        destroyBig(g);
+        g = 0;
+        while (ys && !g)
+        {
+            ys = _rhoNext(mc, ys, pw, c);
+            d = ys ? subBig(x, ys) : 0;
+            t = d ? gcdBig(d, mc->m_) : 0;
+            destroyBig(d);
+            if (!t) break;
+            if (!ISONE(t)) g = t;
+            else destroyBig(t);
+        }
+
+        /* the walk itself closed, no use */
+        if (g && !compare(g, mc->m_))
+        {
+            destroyBig(g);
+            g = 0;
+        }
+    }
+
+    destroyBig(x);
+    destroyBig(y);
+    destroyBig(ys);
+    destroyBig(q);
+    return g;
+}
+
+Big* pollardRho(Big* n, unsigned int pw, unsigned int* trials,
+                unsigned int first, unsigned int step)
+{
+    /* look for a factor of n > 3 by pollard's rho, walking
+     * x -> x^pw + c for c = first, first+step .. until one splits n.
+     * on entry `trials' is the most steps to take, on exit the
+     * steps taken. return a factor or 0.
+     *
+     * as with Lenstra, a host can give its workers the walks
+     * between them with `first' & `step'.
+     */
+    BigMont mc;
+    Big* f = 0;
+    Big* c;
+    Big* t;
+    unsigned int used = 0;
+    unsigned int ci;
+
+    if (pw < 2) pw = 2;
+
+    if (!ISODD(n))
+    {
+        *trials = 0;
+        return createBigu(2);
+    }
+
+    if (initBigMont(&mc, n))
+    {
+        for (ci = first; !f && used < *trials; ci += step)
+        {
+            t = createBigu(ci);
+            c = toBigMont(&mc, t);
+            destroyBig(t);
+            if (!c) break;
+
+            f = _rhoWalk(&mc, pw, c, *trials, &used);
+            destroyBig(c);
+            if (EscapeKeyPressed()) break;
+        }
+    }
+    *trials = used;
+    return f;
+}
+
+static BIG_THREAD unsigned long randomNumber;
 
 void setrandomN(unsigned long v)
 {
@@ -2224,6 +3643,16 @@ unsigned int modBig(Big* n, unsigned int m)
 {
     unsigned int mod;
 
+    if (!NEGATIVE(n) && m && (BigDouble)m < BBASE)
+    {
+        /* single limb divisor, by remainders */
+        BigDouble w = 0;
+        unsigned int i;
+        for (i = DIGITS(n); i > 0; --i)
+            w = ((w << BASEBITS) | n[i]) % m;
+        return (unsigned int)w;
+    }
+
     Big* r;
     Big* d = createBigu(m);
     destroyBig(divBig(n, d, &r));
@@ -2236,19 +3665,25 @@ unsigned int modBig(Big* n, unsigned int m)
 bool BigToMF(Big* b, MF* er)
 {
     unsigned int d = DIGITS(b);
-    unsigned int i;
-    int v;
+    unsigned int i, j;
 
-    MF base((uint4)BBASE);
+    // take limbs 16 bits at a time
+    MF base((uint4)0x10000);
     MF bp(1);
     MF res(0);
 
     i = 1;
     if (i <= d) for (;;)
     {
-        v = b[i];
-        MF dv(v);
-        res += (dv*bp);
+        Big v = b[i];
+        for (j = 0;;)
+        {
+            MF dv((uint4)(v & 0xffff));
+            res += (dv*bp);
+            if ((j += 16) >= BASEBITS) break;
+            v = (Big)(v >> 8 >> 8);
+            bp *= base;
+        }
         if (++i > d) break;
         bp *= base;
     }
@@ -2276,6 +3711,7 @@ bool BigFracToMF(BigFrac* b, MF* mf)
 bool factorFrac(const BigFrac* a, BigFrac* c)
 {
     bool res = false;
+    _lowFrac(a);
     if (ISONE(a->y_)) 
     {
         c->y_ = constOne;
@@ -2360,14 +3796,24 @@ bool factorFrac(const BigFrac* a, BigFrac* c)
 
                 if (!prime)
                 {
-                    // try a bit of lenstra
-                    BigInt f;
-                    bool v = Lenstra(n, f, 500);
-                    if (v)
+                    // try a little rho, then a bit of lenstra
+                    unsigned int tr = RHO_TRIALS;
+                    Big* r = pollardRho(a->x_, 2, &tr);
+                    if (r)
                     {
-                        c->x_ = f.give();
+                        c->x_ = r;
                         res = true;
                     }
+                    else
+                    {
+                        BigInt f;
+                        bool v = Lenstra(n, f, 500);
+                        if (v)
+                        {
+                            c->x_ = f.give();
+                            res = true;
+                        }
+                    }
                 }
 
                 n.give();
@@ -2380,6 +3826,7 @@ bool factorFrac(const BigFrac* a, BigFrac* c)
 
 bool factorialFrac(const BigFrac* a, BigFrac* c)
 {
+    _lowFrac(a);
     if (!ISONE(a->y_) || SIGNBIT(a->x_)) return false;
 
     c->y_ = constOne;
@@ -26,33 +26,92 @@
 
 #include "bcd.h"
 
+/* the calculator add-in is built with the hitachi SH compiler.
+ * anything else is a host, which can afford bigger caches.
+ */
+#ifdef __HITACHI__
+#define BIG_CALC
+#endif
+
+/* the limb pool, the caches and the random state are per thread on
+ * hosts, so that workers can factor in parallel. the add-in has one
+ * thread.
+ */
+#ifdef BIG_CALC
+#define BIG_THREAD
+#elif defined(_MSC_VER)
+#define BIG_THREAD                      __declspec(thread)
+#else
+#define BIG_THREAD                      __thread
+#endif
+
+/* limb size. the calculator uses 16 bit limbs. hosts can build
+ * with BIG_LIMBBITS 32 or 64 for fewer, wider limbs. `BigDouble'
+ * must be exactly twice the width of a limb, 64 bit limbs need
+ * a compiler with 128 bit integers. `BigSigned' is a signed
+ * `BigDouble'.
+ */
+#ifndef BIG_LIMBBITS
+#define BIG_LIMBBITS                    16
+#endif
+
+#if BIG_LIMBBITS == 64
+typedef unsigned long long Big;
+typedef unsigned __int128 BigDouble;
+typedef __int128 BigSigned;
+#define BASEBITSBITS                    6
+#elif BIG_LIMBBITS == 32
+typedef unsigned int Big;
+typedef unsigned long long BigDouble;
+typedef long long BigSigned;
+#define BASEBITSBITS                    5
+#else
 typedef unsigned short Big;
+typedef unsigned int BigDouble;
+typedef int BigSigned;
+#define BASEBITSBITS                    4
+#endif
+
 typedef BCD MF;
 
-#define BASEBITS                        16
-#define BASEBITSBITS                    4
-#define BBASE                           0x10000L
+#define BASEBITS                        (1 << BASEBITSBITS)
+#define BBASE                           ((BigDouble)1 << BASEBITS)
+#define TOPBIT                          ((Big)1 << (BASEBITS-1))
 
-#define DIGITS(_x)                      ((_x)[0] & 0x7fff)
-#define NEGATIVE(_x)                    ((_x)[0] & 0x8000)
-#define ASINT(_x)                       (NEGATIVE(_x) ? -(_x)[1] : (_x)[1])
+#define DIGITS(_x)                      ((_x)[0] & (TOPBIT-1))
+#define NEGATIVE(_x)                    ((_x)[0] & TOPBIT)
+#define ASINT(_x)                       (NEGATIVE(_x) ? -(int)(_x)[1] : (int)(_x)[1])
 #define ISZERO(_x)                      ((_x)[0] == 1 && (_x)[1] == 0)
 #define ISONE(_x)                       ((_x)[0] == 1 && (_x)[1] == 1)
 #define ISTWO(_x)                       ((_x)[0] == 1 && (_x)[1] == 2)
 #define ISODD(_x)                       ((_x)[1] & 1)
 
-#define SIGNBIT(_x)                     ((_x)[0] >> 15)
-#define SET_HEAD(_x, _s, _d)            ((_x)[0] = ((_s) << 15) | (_d))
-#define SET_SIGNIF(_x, _s)              ((_x)[0] |= ((_s) << 15))
-#define SET_SIGNOF(_x, _y)              ((_x)[0] |= ((_y)[0] & 0x8000))
-#define RESET_SIGN(_x)                  ((_x)[0] & 0x7fff)
-#define NEGATEBIT(_x)                   ((_x)[0] ^= 0x8000)
+#define SIGNBIT(_x)                     ((int)((_x)[0] >> (BASEBITS-1)))
+#define SET_HEAD(_x, _s, _d)            ((_x)[0] = ((Big)(_s) << (BASEBITS-1)) | (_d))
+#define SET_SIGNIF(_x, _s)              ((_x)[0] |= ((Big)(_s) << (BASEBITS-1)))
+#define SET_SIGNOF(_x, _y)              ((_x)[0] |= ((_y)[0] & TOPBIT))
+#define RESET_SIGN(_x)                  ((_x)[0] & (TOPBIT-1))
+#define NEGATEBIT(_x)                   ((_x)[0] ^= TOPBIT)
 
 void    InitBig();
 void    finishBig();
+void    finishBigThread();
+
+/* limb buffer accounting */
+struct BigAllocStats
+{
+    unsigned long       allocs_;        // buffers handed out
+    unsigned long       heapAllocs_;    // of those, new from the heap
+    unsigned long       bytes_;         // in use now
+    unsigned long       peakBytes_;     // most in use at once
+};
+
+void    bigAllocStats(BigAllocStats*);
+void    resetBigAllocStats();
 
 /* Forward Decls */
 struct BigFrac;
+struct BigMont;
 
 typedef void (*streamFn)(void* stream, char);
 
@@ -73,6 +132,15 @@ Big*    rootBig(Big*);
 Big*    mulBigMod(Big* a, Big* b, Big* m);
 Big*    powerBigMod(Big* b, Big* n, Big* m);
 Big*    powerBigintMod(Big* b, unsigned int n, Big* m);
+
+/* montgomery, see BigMont */
+bool    initBigMont(BigMont*, Big* m);
+void    finishBigMont(BigMont*);
+Big*    toBigMont(BigMont*, Big* a);
+Big*    fromBigMont(BigMont*, Big* a);
+Big*    mulBigMont(BigMont*, Big* a, Big* b);
+Big*    powerBigMont(BigMont*, Big* b, Big* e);
+
 Big*    addint(Big* a, unsigned int b);
 Big*    subint(Big* a, unsigned int b);
 Big*    mulint(Big*, int);
@@ -82,6 +150,7 @@ Big*    one();
 Big*    zero();
 Big*    sqrBig(Big*);
 unsigned int bigAsUint(Big* b);
+unsigned int modBig(Big* n, unsigned int m);
 unsigned int log2(Big*);
 unsigned int log10(Big*);
 inline bool    isNeg(Big* a) { return a && SIGNBIT(a) != 0; }
@@ -115,6 +184,10 @@ bool            nRootFrac(BigFrac* a, unsigned int k, BigFrac* c);
 unsigned int    fracAsUint(BigFrac*);
 void            asStringFrac(const BigFrac*, streamFn, void*);
 bool            sameFrac(BigFrac* a, BigFrac* b);
+bool            normFrac(BigFrac*);
+bool            isIntFrac(BigFrac*);
+unsigned int    setFracLazy(unsigned int bits);
+unsigned int    fracLazy();
 
 /* destructive */
 void            destroyFrac(BigFrac*);
@@ -134,6 +207,28 @@ struct BigFrac
     Big*        y_;
 };
 
+struct BigMont
+{
+    // montgomery context for an odd modulus, see initBigMont.
+    // residues are aR mod m with R = B^n.
+                        BigMont() { m_ = 0; r2_ = 0; ws_ = 0; }
+                        ~BigMont() { finishBigMont(this); }
+
+    bool                valid() const { return m_ != 0; }
+
+    Big*                m_;     // modulus, own copy
+    unsigned int        n_;     // limbs in m_
+    Big                 minv_;  // -1/m mod B
+    Big*                r2_;    // R^2 mod m
+    Big*                ws_;    // products and karatsuba workspace
+
+private:
+
+    // not copyable
+                        BigMont(const BigMont&);
+    void                operator=(const BigMont&);
+};
+
 /* conversions */
 bool BigToMF(Big* b, MF*);
 bool BigFracToMF(BigFrac* b, MF*);
@@ -142,10 +237,15 @@ bool BCDToFrac(const BCD& a, const BCD& b, BigFrac* c);
 unsigned long randomN();
 void setrandomN(unsigned long v);
 
+/* odd primes below SMALLPRIME_LIMIT, as half gaps */
+unsigned int smallPrimes(const unsigned char** gaps);
+
 /* Other functions */
 Big*                    pollardRho(Big* n,
                                    unsigned int pw,
-                                   unsigned int* trials);
+                                   unsigned int* trials,
+                                   unsigned int first = 1,
+                                   unsigned int step = 1);
 bool                    factorialFrac(const BigFrac* a, BigFrac* c);
 bool                    factorFrac(const BigFrac* a, BigFrac* c);
 bool                    parallelFrac(BigFrac* a, BigFrac* b, BigFrac* c);
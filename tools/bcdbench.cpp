@@ -0,0 +1,283 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only timings for the bcd kernels, not part of the add-in.
+ * build from this directory,
+ *
+ * g++ -O2 -I.. bcdbench.cpp ../bcdmath.cpp ../bcdfloat.cpp
+ *     ../bcdfloat2.cpp ../bcd.cpp ../cutils.c -o bcdbench
+ *
+ * the sections are
+ *
+ * batch  bcd_*_n against a loop of the scalar kernels, ns per element.
+ * ops    ns per add, mul, div and fma at P and P2. there is no fma
+ *        at P2. add -D'DIVBASE(_v)=((_v)/BASE)' to time the limb
+ *        loops with a plain divide.
+ * widths ns per add, mul and div through the value wrappers of each
+ *        width, BCD8 up to BCD64. the kernels take the size at run
+ *        time, nothing is specialised by width.
+ * math   ns per sin, cos, log and exp. build a second time with
+ *        -DBCD_CONST_COPY to time the constants copied out of the
+ *        table on every use, as they were.
+ *
+ * give section names to run only those, otherwise all run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bcdfloat.h"
+#include "bcdfloat2.h"
+#include "bcd2.h"
+#include "bcdx.h"
+#include "bcdmath.h"
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static double now()
+{
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static void rndBCD(unsigned short* d, int pn)
+{
+    /* finite, either sign, exponents close enough to overlap */
+    int i;
+    d[0] = 1 + rnd() % (BASE-1);
+    for (i = 1; i < pn; ++i) d[i] = rnd() % BASE;
+    SET_EXP(d, pn, (int)(rnd() % 9) - 4);
+    if (rnd() & 1) NEGATE_SIGN(d, pn);
+}
+
+#define NBATCH  1024
+
+static void benchBatch()
+{
+    static const char* names[] = { "add", "sub", "mul", "div", "fma" };
+    static BCDFloatData a[NBATCH], b[NBATCH], d[NBATCH], c[NBATCH];
+    unsigned short tmp[2*P+5];
+    int i, k, op;
+
+    for (i = 0; i < NBATCH; ++i)
+    {
+        rndBCD(a[i]._d, P);
+        rndBCD(b[i]._d, P);
+        rndBCD(d[i]._d, P);
+    }
+
+    printf("batch: ns per element, %d elements a run\n", NBATCH);
+    printf("op     scalar    batch\n");
+    for (op = 0; op < 5; ++op)
+    {
+        int reps = 2000;
+        double t0 = now();
+        for (k = 0; k < reps; ++k)
+        {
+            for (i = 0; i < NBATCH; ++i)
+            {
+                switch (op)
+                {
+                case 0: bcd_add(a[i]._d, b[i]._d, c[i]._d, P, P); break;
+                case 1: bcd_sub(a[i]._d, b[i]._d, c[i]._d, P, P); break;
+                case 2: bcd_mul(a[i]._d, b[i]._d, c[i]._d, tmp, P, P); break;
+                case 3: bcd_div(a[i]._d, b[i]._d, c[i]._d, tmp, P, P); break;
+                case 4: bcd_fma(a[i]._d, b[i]._d, d[i]._d, c[i]._d, P); break;
+                }
+            }
+        }
+        double t1 = now();
+        for (k = 0; k < reps; ++k)
+        {
+            switch (op)
+            {
+            case 0: bcd_add_n(a, b, c, NBATCH); break;
+            case 1: bcd_sub_n(a, b, c, NBATCH); break;
+            case 2: bcd_mul_n(a, b, c, NBATCH); break;
+            case 3: bcd_div_n(a, b, c, NBATCH); break;
+            case 4: bcd_fma_n(a, b, d, c, NBATCH); break;
+            }
+        }
+        double t2 = now();
+
+        double n = (double)reps*NBATCH;
+        printf("%-5s %7.1f %8.1f\n", names[op],
+               1e9*(t1 - t0)/n, 1e9*(t2 - t1)/n);
+    }
+}
+
+static void benchOps()
+{
+    static unsigned short a[NBATCH][P2+1], b[NBATCH][P2+1];
+    static unsigned short d[NBATCH][P2+1], c[NBATCH][P2+1];
+    unsigned short tmp[2*P2+5];
+    const int pns[] = { P, P2 };
+    int i, k, m;
+
+    printf("ops: ns per op\n");
+    printf(" pn     add      mul      div      fma\n");
+    for (m = 0; m < 2; ++m)
+    {
+        int pn = pns[m];
+        for (i = 0; i < NBATCH; ++i)
+        {
+            rndBCD(a[i], pn);
+            rndBCD(b[i], pn);
+            rndBCD(d[i], pn);
+        }
+
+        int reps = 1000;
+        double n = (double)reps*NBATCH;
+        double t0 = now();
+        for (k = 0; k < reps; ++k)
+            for (i = 0; i < NBATCH; ++i) bcd_add(a[i], b[i], c[i], pn, pn);
+        double t1 = now();
+        for (k = 0; k < reps; ++k)
+            for (i = 0; i < NBATCH; ++i) 
+                bcd_mul(a[i], b[i], c[i], tmp, pn, pn);
+        double t2 = now();
+        for (k = 0; k < reps; ++k)
+            for (i = 0; i < NBATCH; ++i) 
+                bcd_div(a[i], b[i], c[i], tmp, pn, pn);
+        double t3 = now();
+        printf("%3d %7.1f %8.1f %8.1f", pn,
+               1e9*(t1 - t0)/n, 1e9*(t2 - t1)/n, 1e9*(t3 - t2)/n);
+
+        if (pn == P)
+        {
+            for (k = 0; k < reps; ++k)
+                for (i = 0; i < NBATCH; ++i) 
+                    bcd_fma(a[i], b[i], d[i], c[i], pn);
+            printf(" %8.1f", 1e9*(now() - t3)/n);
+        }
+        printf("\n");
+    }
+}
+
+/* time one width. because we hate templates, a macro. */
+#define BENCH_WIDTH(_W, _pn)                                            \
+{                                                                       \
+    static _W a[NBATCH], b[NBATCH], c[NBATCH];                          \
+    unsigned short d[P2+1];                                             \
+    int i, k;                                                           \
+    for (i = 0; i < NBATCH; ++i)                                        \
+    {                                                                   \
+        rndBCD(d, P); a[i] = BCD(*(BCDFloatData*)d);                    \
+        rndBCD(d, P); b[i] = BCD(*(BCDFloatData*)d);                    \
+    }                                                                   \
+    int reps = 500;                                                     \
+    double n = (double)reps*NBATCH;                                     \
+    double t0 = now();                                                  \
+    for (k = 0; k < reps; ++k)                                          \
+        for (i = 0; i < NBATCH; ++i) c[i] = a[i] + b[i];                \
+    double t1 = now();                                                  \
+    for (k = 0; k < reps; ++k)                                          \
+        for (i = 0; i < NBATCH; ++i) c[i] = a[i]*b[i];                  \
+    double t2 = now();                                                  \
+    for (k = 0; k < reps; ++k)                                          \
+        for (i = 0; i < NBATCH; ++i) c[i] = a[i]/b[i];                  \
+    double t3 = now();                                                  \
+    printf("%-6s %3d %7.1f %8.1f %8.1f\n", #_W, _pn,                   \
+           1e9*(t1 - t0)/n, 1e9*(t2 - t1)/n, 1e9*(t3 - t2)/n);          \
+}
+
+static void benchWidths()
+{
+    printf("widths: ns per op\n");
+    printf("type    pn     add      mul      div\n");
+    BENCH_WIDTH(BCD8, P8);
+    BENCH_WIDTH(BCD16, P16);
+    BENCH_WIDTH(BCD, P);
+    BENCH_WIDTH(BCD32, P32);
+    BENCH_WIDTH(BCD2, P2);
+    BENCH_WIDTH(BCD64, P64);
+}
+
+static void benchMath()
+{
+    /* arguments over a few periods and decades, so that the
+     * reductions take their usual paths.
+     */
+    static BCD x[NBATCH], y[NBATCH];
+    BCD s;
+    int i, k;
+    for (i = 0; i < NBATCH; ++i)
+    {
+        x[i] = BCD((int4)(rnd() % 20000) - 10000)/BCD(1000);
+        y[i] = BCD((int4)(1 + rnd() % 100000))/BCD(100);
+    }
+
+#ifdef BCD_CONST_COPY
+    printf("math: ns per call, constants copied\n");
+#else
+    printf("math: ns per call, constants in place\n");
+#endif
+    printf("      sin      cos      log      exp\n");
+
+    int reps = 200;
+    double n = (double)reps*NBATCH;
+    double t0 = now();
+    for (k = 0; k < reps; ++k)
+        for (i = 0; i < NBATCH; ++i) s += bcdmath::sin(x[i]);
+    double t1 = now();
+    for (k = 0; k < reps; ++k)
+        for (i = 0; i < NBATCH; ++i) s += bcdmath::cos(x[i]);
+    double t2 = now();
+    for (k = 0; k < reps; ++k)
+        for (i = 0; i < NBATCH; ++i) s += bcdmath::log(y[i]);
+    double t3 = now();
+    for (k = 0; k < reps; ++k)
+        for (i = 0; i < NBATCH; ++i) s += bcdmath::exp(x[i]);
+    double t4 = now();
+
+    // print the sum so that the calls are not dropped
+    printf("%8.1f %8.1f %8.1f %8.1f  (%s)\n",
+           1e9*(t1 - t0)/n, 1e9*(t2 - t1)/n, 1e9*(t3 - t2)/n,
+           1e9*(t4 - t3)/n, s.asString());
+}
+
+static bool wanted(int argc, char** argv, const char* name)
+{
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; ++i)
+        if (!strcmp(argv[i], name)) return true;
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    if (wanted(argc, argv, "batch")) benchBatch();
+    if (wanted(argc, argv, "ops")) benchOps();
+    if (wanted(argc, argv, "widths")) benchWidths();
+    if (wanted(argc, argv, "math")) benchMath();
+    return 0;
+}
@@ -0,0 +1,406 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only differential tests for the bcd kernels, not part of
+ * the add-in.
+ *
+ * bcdfloat.cpp and bcdmath.cpp are included here so that their static
+ * functions can be checked directly. build from this directory,
+ *
+ * g++ -O2 -I.. bcdtest.cpp ../bcdv.cpp ../bcdfloat2.cpp ../bcd.cpp
+ *     ../cutils.c -o bcdtest
+ *
+ * exits non-zero if anything disagrees.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bcdfloat.cpp"
+#include "bcdmath.cpp"
+#include "bcdx.h"
+#include "bcdv.h"
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    // xorshift, so runs repeat on every host
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static void rndMant(unsigned short* d, int pn)
+{
+    /* `pn' 4decs, normalised, sometimes all 9999 */
+    int i;
+    if (!(rnd() & 15))
+    {
+        for (i = 0; i < pn; ++i) d[i] = BASE-1;
+        return;
+    }
+    d[0] = 1 + rnd() % (BASE-1);
+    for (i = 1; i < pn; ++i) d[i] = rnd() % BASE;
+}
+
+static void rndBCD(BCDFloatData& v)
+{
+    /* mostly finite values of either sign with exponents close
+     * enough to overlap, and some zeros, infinities, nans and
+     * exponents near the limits.
+     */
+    int i;
+    for (i = 0; i <= P; ++i) v._d[i] = 0;
+
+    unsigned int k = rnd() % 64;
+    if (k == 0) return;
+    if (k == 1) { v._d[P] = POS_INF_EXP; return; }
+    if (k == 2) { v._d[P] = NEG_INF_EXP; return; }
+    if (k == 3) { v._d[P] = NAN_EXP; return; }
+
+    rndMant(v._d, P);
+    int e;
+    if (k < 8) e = (int)(rnd() % (2*EXPLIMIT - 1)) - (EXPLIMIT - 1);
+    else e = (int)(rnd() % 17) - 8;
+    SET_EXP(v._d, P, e);
+    if (rnd() & 1) NEGATE_SIGN(v._d, P);
+}
+
+static bool same(const BCDFloatData& a, const BCDFloatData& b)
+{
+    return !memcmp(a._d, b._d, sizeof(a._d));
+}
+
+static int testDivbase()
+{
+    /* DIVBASE against the divide, over every 32 bit value */
+    int bad = 0;
+    uint4 v = 0;
+    do
+    {
+        if ((uint4)DIVBASE(v) != v/BASE)
+        {
+            if (++bad < 5) printf("DIVBASE(%u) differs\n", v);
+        }
+    } while (++v);
+    return bad;
+}
+
+static int testBatch(int iters)
+{
+    /* bcd_*_n against the scalar kernels, element by element */
+    const int n = 64;
+    BCDFloatData a[n], b[n], d[n], c[n], r;
+    unsigned short tmp[2*P+5];
+    int bad = 0;
+
+    for (int it = 0; it < iters; ++it)
+    {
+        int i;
+        for (i = 0; i < n; ++i)
+        {
+            rndBCD(a[i]);
+            rndBCD(b[i]);
+            rndBCD(d[i]);
+        }
+
+        for (int op = 0; op < 5; ++op)
+        {
+            switch (op)
+            {
+            case 0: bcd_add_n(a, b, c, n); break;
+            case 1: bcd_sub_n(a, b, c, n); break;
+            case 2: bcd_mul_n(a, b, c, n); break;
+            case 3: bcd_div_n(a, b, c, n); break;
+            case 4: bcd_fma_n(a, b, d, c, n); break;
+            }
+
+            for (i = 0; i < n; ++i)
+            {
+                switch (op)
+                {
+                case 0: bcd_add(a[i]._d, b[i]._d, r._d, P, P); break;
+                case 1: bcd_sub(a[i]._d, b[i]._d, r._d, P, P); break;
+                case 2: bcd_mul(a[i]._d, b[i]._d, r._d, tmp, P, P); break;
+                case 3: bcd_div(a[i]._d, b[i]._d, r._d, tmp, P, P); break;
+                case 4: bcd_fma(a[i]._d, b[i]._d, d[i]._d, r._d, P); break;
+                }
+                if (!same(c[i], r))
+                {
+                    if (++bad < 5) printf("batch op %d differs\n", op);
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+static void mulwRef(const unsigned short* a, int pa,
+                    const unsigned short* b, int pb,
+                    unsigned short* w)
+{
+    /* the product loop bcd_op_mul had before bcd_mulw, carrying
+     * row by row with a divide per limb.
+     */
+    int ca;
+    int i, j;
+    int4 u, v;
+
+    w += pa;
+    CLEAR(w, pb);
+    i = pa - 1;
+    for (;;)
+    {
+        ca = 0;
+        u = a[i];
+        if (u)
+        {
+            for (j = pb-1; j >= 0; --j) 
+            {
+                v = b[j]*u + w[j] + ca;
+                ca = 0;
+                if (v >= BASE) 
+                {
+                    ca = v / BASE;
+                    v = v - ca*BASE;
+                }
+                w[j] = v;
+            }
+        }
+        *--w = ca;
+        if (!i) break;
+        --i;
+    }
+}
+
+static int testMulw(int iters)
+{
+    /* bcd_mulw against the old kernel, on operands up to MAX_P long
+     * for the deferred carry path and longer for the other.
+     */
+    const int maxn = 3*MAX_P;
+    unsigned short a[maxn], b[maxn], w[2*maxn], r[2*maxn];
+    int bad = 0;
+
+    for (int it = 0; it < iters; ++it)
+    {
+        int pa = 1 + rnd() % ((it & 7) ? MAX_P : maxn);
+        int pb = 1 + rnd() % ((it & 7) ? MAX_P : maxn);
+        rndMant(a, pa);
+        rndMant(b, pb);
+        if (rnd() & 1) a[rnd() % pa] = 0;
+
+        bcd_mulw(a, pa, b, pb, w);
+        mulwRef(a, pa, b, pb, r);
+        if (memcmp(w, r, (pa + pb)*sizeof(unsigned short)))
+        {
+            if (++bad < 5) printf("mulw %d x %d differs\n", pa, pb);
+        }
+    }
+    return bad;
+}
+
+static BCD rndDigits(int pn, int e)
+{
+    /* a P value with `pn' random 4decs near BASE^e */
+    BCDFloatData a;
+    for (int i = 0; i <= P; ++i) a._d[i] = 0;
+    rndMant(a._d, pn);
+    SET_EXP(a._d, P, e);
+    if (rnd() & 1) NEGATE_SIGN(a._d, P);
+    return a;
+}
+
+static bool holds(const unsigned short* w, int pn, const BCD& x)
+{
+    /* `w' of `pn' 4decs is `x' with zeros after */
+    int i;
+    for (i = 0; i < P; ++i) if (w[i] != x._v._d[i]) return false;
+    for (; i < pn; ++i) if (w[i]) return false;
+    return w[pn] == x._v._d[P];
+}
+
+static int testWidths(int iters)
+{
+    /* BCD8 and BCD16 arithmetic against the same operation at P, 
+     * narrowed, for operands where the result at P is exact. BCD32
+     * and BCD64 must widen a P value exactly.
+     */
+    int bad = 0;
+    for (int it = 0; it < iters; ++it)
+    {
+        /* the add/sub kernels round exactly for operands at most one
+         * 4dec apart. further apart they can be a unit out at short
+         * precisions, as they always were.
+         */
+        int ea = (int)(rnd() % 9) - 4;
+        int eb = ea + (int)(rnd() % 3) - 1;
+        BCD8 a8(rndDigits(P8, ea));
+        BCD8 b8(rndDigits(P8, eb));
+        BCD x = a8.asBCD();
+        BCD y = b8.asBCD();
+        if (BCD8(x + y) != a8 + b8 || BCD8(x - y) != a8 - b8 ||
+            BCD8(x*y) != a8*b8)
+        {
+            if (++bad < 5) printf("BCD8 differs\n");
+        }
+
+        BCD16 a16(rndDigits(P16, ea));
+        BCD16 b16(rndDigits(P16, eb));
+        x = a16.asBCD();
+        y = b16.asBCD();
+        if (BCD16(x + y) != a16 + b16 || BCD16(x - y) != a16 - b16)
+        {
+            if (++bad < 5) printf("BCD16 differs\n");
+        }
+
+        x = BCD(rndDigits(P, ea))/BCD(1 + rnd() % 97);
+        BCD32 x32(x);
+        BCD64 x64(x);
+        if (!holds(x32._v._d, P32, x) || !holds(x64._v._d, P64, x))
+        {
+            if (++bad < 5) printf("BCD32/64 widening differs\n");
+        }
+    }
+    return bad;
+}
+
+namespace bcdmath
+{
+
+static BCD expOld(const BCD& v)
+{
+    /* exp as it was before the table, from r/64 raised to the 64th */
+    if (v.isSpecial()) 
+    {
+        if (v.isInf() && v.isNeg()) return 0;
+        return v;
+    }
+    if (v.isZero()) return 1;
+
+    BCD ln2; GET_CONST(ln2, BCD_CONST_LN2);
+    BCD n = trunc(v/ln2);
+    if (n > 33218) return BCDFloat::posInf();
+    else if (n < -33218) return 0;
+
+    int ni = itrunc(n);
+    int k = 64;
+    BCD r = (v - n*ln2)/k;
+    
+    BCD t1 = _expm1(r);
+    BCD er = t1 + 1;
+    BCD del = t1 - (er - 1);
+    t1 = pow(er,k);
+    er = t1 + t1/er*del*k;
+    return er*pow(BCD(2), ni);
+}
+
+}; // namespace
+
+static BCD unitsOff(const BCD& x, const BCDV& ref)
+{
+    /* relative distance of `x' from `ref' in units of the last of
+     * the DDIGITS(P) digits a BCD promises.
+     */
+    BCDV d = fabs((BCDV(x) - ref)/ref);
+    for (int i = 1; i < DDIGITS(P); ++i) d.mulInt(10);
+    return d.asBCD();
+}
+
+static int testExp(int iters)
+{
+    /* exp against the old method, both measured against a 60 digit
+     * reference. the new one must be within a unit of the last digit.
+     */
+    int bad = 0;
+    int worse = 0;
+    BCD maxNew = 0;
+    BCD maxOld = 0;
+    BCDV::setDigits(60);
+
+    for (int it = 0; it < iters; ++it)
+    {
+        // below 1, below 10000 and on to the range limits
+        BCDFloatData a;
+        for (int i = 0; i <= P; ++i) a._d[i] = 0;
+        rndMant(a._d, P);
+        int s = it % 3;
+        SET_EXP(a._d, P, s == 0 ? -(int)(rnd() % 3) : 1);
+        if (rnd() & 1) NEGATE_SIGN(a._d, P);
+        BCD v(a);
+        if (s == 2) v = v*BCD(24)/BCD(10);
+
+        BCD x = bcdmath::exp(v);
+        BCD y = bcdmath::expOld(v);
+        if (x.isSpecial() || x.isZero())
+        {
+            if (x != y && ++bad < 5)
+                printf("exp(%s) at the range limit differs\n", v.asString());
+            continue;
+        }
+        
+        BCDV ref = bcdmath::exp(BCDV(v));
+        BCD un = unitsOff(x, ref);
+        BCD uo = unitsOff(y, ref);
+        if (un > maxNew) maxNew = un;
+        if (uo > maxOld) maxOld = uo;
+        if (un > uo) ++worse;
+        if (un > 1 && ++bad < 5)
+        {
+            printf("exp(%s) ", v.asString());
+            printf("out by %s\n", un.asString());
+        }
+    }
+    printf("exp: worst %s units, ", maxNew.asString());
+    printf("was %s, worse than old %d of %d\n", maxOld.asString(), worse, iters);
+    return bad;
+}
+
+int main(int argc, char** argv)
+{
+    int iters = argc > 1 ? atoi(argv[1]) : 2000;
+    int bad, total = 0;
+
+    bad = testDivbase();
+    printf("divbase  %d bad\n", bad);
+    total += bad;
+
+    bad = testBatch(iters);
+    printf("batch    %d bad\n", bad);
+    total += bad;
+
+    bad = testMulw(iters*10);
+    printf("mulw     %d bad\n", bad);
+    total += bad;
+
+    bad = testWidths(iters*10);
+    printf("widths   %d bad\n", bad);
+    total += bad;
+
+    bad = testExp(iters);
+    printf("exp      %d bad\n", bad);
+    total += bad;
+
+    return total != 0;
+}
@@ -0,0 +1,597 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only timings for mi.cpp and bigs.cpp, not part of the add-in.
+ * build from this directory,
+ *
+ * g++ -O2 -I.. bigbench.cpp hoststub.cpp ../bigs.cpp ../big.cpp
+ *     ../bcdfloat.cpp ../bcd.cpp ../cutils.c -o bigbench
+ *
+ * with -DBIG_LIMBBITS=32 or 64 to compare limb widths. the sections
+ * are
+ *
+ * tune   schoolbook against one karatsuba split, by limb count. the
+ *        crossover is where KARATSUBA_THRESHOLD belongs.
+ * ops    add, mul, sqr, div and gcd at 100, 1000 and 10000 digits.
+ * prime  baillie-psw against the witness loop on primes of 157 to
+ *        969 digits.
+ * ecm    Lenstra on semiprimes, by size of the smaller factor.
+ * rho    pollardRho on the same, with the steps it took.
+ * nextprime  nextPrime from random starts, and the primes counted
+ *        over a range from 10^d, sieved against an isPrime walk.
+ * div    2d by d digits, newton against algorithm D.
+ * radix  print and parse of d digits, split on powers of ten
+ *        against a digit group at a time.
+ * harmonic  1 + 1/2 + ... + 1/n as fractions, reduced every step
+ *        against lazily.
+ * cfrac  a continued fraction of n random terms evaluated from the
+ *        back, reduced every step against lazily.
+ *
+ * give section names to run only those, otherwise all run. k=<n>
+ * runs the rest with a karatsuba threshold of n limbs, likewise d=<n>
+ * for DIVNEWTON_THRESHOLD and r=<n> for RADIX_DC_THRESHOLD. z=<n>
+ * sets the lazy fraction trigger in bits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* the thresholds are variables here, so that they can be changed
+ * between runs. they start at the mi.cpp defaults.
+ */
+static unsigned int karatsubaThreshold = 24;
+#define KARATSUBA_THRESHOLD     karatsubaThreshold
+static unsigned int divNewtonThreshold = 300;
+#define DIVNEWTON_THRESHOLD     divNewtonThreshold
+static unsigned int radixThreshold = 40;
+#define RADIX_DC_THRESHOLD      radixThreshold
+
+/* lazy runs of the fraction sections leave results unreduced up to
+ * this many bits.
+ */
+static unsigned int lazyBits = 20000;
+
+#include "mi.cpp"
+#include "bigs.h"
+
+extern void hostInit(unsigned int maxDigits);
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static double now()
+{
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static Big* rndDigits(int d)
+{
+    /* random number of exactly `d' decimal digits */
+    char* buf = new char[d + 1];
+    int i;
+    buf[0] = '1' + rnd() % 9;
+    for (i = 1; i < d; ++i) buf[i] = '0' + rnd() % 10;
+    buf[d] = 0;
+
+    const char* p = buf;
+    Big* b = parseBig(&p);
+    delete [] buf;
+    return b;
+}
+
+static Big rndLimb()
+{
+    BigDouble v = rnd();
+    v = (v << 16) ^ rnd();
+    v = (v << 16) ^ rnd();
+    return (Big)v;
+}
+
+static Big* rndLimbs(unsigned int n)
+{
+    /* `n' random limbs */
+    Big* b = _create(n);
+    unsigned int i;
+    for (i = 1; i <= n; ++i) b[i] = rndLimb();
+    if (!b[n]) b[n] = 1;
+    SET_HEAD(b, 0, n);
+    return b;
+}
+
+static int repsFor(double n2)
+{
+    /* repeats so that an n^2 operation takes a measurable time */
+    int r = (int)(4e6/n2);
+    return r < 3 ? 3 : r;
+}
+
+static void benchTune()
+{
+    static const unsigned int sizes[] =
+        { 8, 12, 16, 20, 24, 32, 48, 64, 96, 128, 256, 0 };
+
+    printf("tune: us per op, %d bit limbs, threshold %d\n",
+           BASEBITS, KARATSUBA_THRESHOLD);
+    printf("limbs   mulRaw   karatsuba   sqrRaw   karatsuba\n");
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Big* a = rndLimbs(n);
+        Big* b = rndLimbs(n);
+        Big* r = new Big[2*n];
+
+        // split once, the halves go schoolbook
+        unsigned int kt = karatsubaThreshold;
+        karatsubaThreshold = n;
+        Big* ws = new Big[_karatsubaSpace(n)];
+
+        int reps = repsFor((double)n*n);
+        int i;
+        double t0 = now();
+        for (i = 0; i < reps; ++i) _mulRaw(a + 1, n, b + 1, n, r);
+        double t1 = now();
+        for (i = 0; i < reps; ++i) _karatsuba(a + 1, b + 1, n, r, ws);
+        double t2 = now();
+        for (i = 0; i < reps; ++i) _sqrRaw(a + 1, n, r);
+        double t3 = now();
+        for (i = 0; i < reps; ++i) _karatsuba(a + 1, a + 1, n, r, ws);
+        double t4 = now();
+
+        printf("%5u %9.2f %11.2f %8.2f %11.2f\n", n,
+               1e6*(t1 - t0)/reps, 1e6*(t2 - t1)/reps,
+               1e6*(t3 - t2)/reps, 1e6*(t4 - t3)/reps);
+
+        karatsubaThreshold = kt;
+        delete [] ws;
+        delete [] r;
+        destroyBig(a);
+        destroyBig(b);
+    }
+}
+
+static void benchOps()
+{
+    static const int digits[] = { 100, 1000, 10000, 0 };
+
+    printf("ops: us per op, %d bit limbs\n", BASEBITS);
+    printf("digits      add        mul        sqr        div        gcd\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        int d = digits[k];
+        Big* a = rndDigits(d);
+        Big* b = rndDigits(d);
+        Big* a2 = mulBig(a, b);
+        Big* q;
+        Big* r;
+        int reps = repsFor((double)d*d/64);
+        int i;
+
+        double t0 = now();
+        for (i = 0; i < reps; ++i) destroyBig(addBig(a, b));
+        double t1 = now();
+        for (i = 0; i < reps; ++i) destroyBig(mulBig(a, b));
+        double t2 = now();
+        for (i = 0; i < reps; ++i) destroyBig(sqrBig(a));
+        double t3 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            q = divBig(a2, b, &r);
+            destroyBig(q);
+            destroyBig(r);
+        }
+        double t4 = now();
+        int greps = reps/8 + 1;
+        for (i = 0; i < greps; ++i) destroyBig(gcdBig(a, b));
+        double t5 = now();
+
+        printf("%6d %8.2f %10.2f %10.2f %10.2f %10.2f\n", d,
+               1e6*(t1 - t0)/reps, 1e6*(t2 - t1)/reps,
+               1e6*(t3 - t2)/reps, 1e6*(t4 - t3)/reps,
+               1e6*(t5 - t4)/greps);
+
+        destroyBig(a);
+        destroyBig(b);
+        destroyBig(a2);
+    }
+}
+
+static void benchPrime()
+{
+    /* mersenne primes of 157, 386 and 969 digits, no search needed */
+    static const unsigned int bits[] = { 521, 1279, 3217, 0 };
+
+    printf("prime: seconds per isPrime of 2^p-1\n");
+    printf("     p     bpsw    witness\n");
+    for (int k = 0; bits[k]; ++k)
+    {
+        Big* t = lshiftn(constOne, bits[k]);
+        BigInt p(subint(t, 1));
+        destroyBig(t);
+
+        double tm[2];
+        for (int m = 0; m < 2; ++m)
+        {
+            setPrimeTest(m ? PRIMETEST_WITNESS : PRIMETEST_BPSW);
+            int reps = bits[k] > 2000 ? 1 : 3;
+            double t0 = now();
+            for (int i = 0; i < reps; ++i) isPrime(p);
+            tm[m] = (now() - t0)/reps;
+        }
+        printf("%6u %8.3f %10.3f\n", bits[k], tm[0], tm[1]);
+    }
+    setPrimeTest(PRIMETEST_BPSW);
+}
+
+static BigInt rndPrime(int d)
+{
+    BigInt p;
+    nextPrime(BigInt(rndDigits(d)), p);
+    return p;
+}
+
+static void benchEcm()
+{
+    static const int digits[] = { 8, 10, 12, 14, 16, 0 };
+    const int per = 3;
+
+    printf("ecm: factor of p.q, q of 25 digits, %d tries each\n", per);
+    printf("digits  found   seconds\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        int found = 0;
+        double t = 0;
+        for (int i = 0; i < per; ++i)
+        {
+            BigInt n = rndPrime(digits[k])*rndPrime(25);
+            BigInt f;
+            double t0 = now();
+            if (Lenstra(n, f, 200) && f != 1 && f != n) ++found;
+            t += now() - t0;
+        }
+        printf("%6d %4d/%d %9.2f\n", digits[k], found, per, t/per);
+    }
+}
+
+static void benchRho()
+{
+    static const int digits[] = { 6, 8, 10, 12, 0 };
+    const int per = 3;
+
+    printf("rho: factor of p.q, q of 25 digits, %d tries each\n", per);
+    printf("digits  found   seconds      steps\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        int found = 0;
+        double t = 0, steps = 0;
+        for (int i = 0; i < per; ++i)
+        {
+            BigInt n = rndPrime(digits[k])*rndPrime(25);
+            Big* m = BigInt(n).give();
+            unsigned int tr = 100000000;
+            double t0 = now();
+            Big* f = pollardRho(m, 2, &tr);
+            t += now() - t0;
+            steps += tr;
+            if (f) ++found;
+            destroyBig(f);
+            destroyBig(m);
+        }
+        printf("%6d %4d/%d %9.2f %10.0f\n", digits[k], found, per,
+               t/per, steps/per);
+    }
+}
+
+static BigInt walkPrime(const BigInt& n0)
+{
+    /* nextPrime as it was, every odd number gets the full test */
+    BigInt n = n0.isEven() ? n0 + 1 : n0 + 2;
+    while (isPrime(n) != 1) n += 2;
+    return n;
+}
+
+static void benchNextPrime()
+{
+    static const int digits[] = { 20, 50, 100, 200, 300, 0 };
+    static const int rdigits[] = { 10, 20, 50, 0 };
+    const int per = 5;
+    const int span = 20000;
+
+    printf("nextprime: ms per call, %d starts each\n", per);
+    printf("digits    sieved       walk\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        BigInt ns[per];
+        BigInt p[per];
+        bool same = true;
+        int i;
+        for (i = 0; i < per; ++i) ns[i] = BigInt(rndDigits(digits[k]));
+
+        double t0 = now();
+        for (i = 0; i < per; ++i) nextPrime(ns[i], p[i]);
+        double t1 = now();
+        for (i = 0; i < per; ++i) if (walkPrime(ns[i]) != p[i]) same = false;
+        double t2 = now();
+        printf("%6d %9.2f %10.2f%s\n", digits[k], 1e3*(t1 - t0)/per,
+               1e3*(t2 - t1)/per, same ? "" : "  differs");
+    }
+
+    printf("range: primes in 10^d .. 10^d+%d, ms\n", span);
+    printf("digits  count    sieved       walk\n");
+    for (int k = 0; rdigits[k]; ++k)
+    {
+        BigInt lo = pow(BigInt(10), rdigits[k]);
+        BigInt hi = lo + span;
+        BigInt p;
+        int c[2] = { 0, 0 };
+
+        double t0 = now();
+        for (nextPrime(lo, p); p <= hi; nextPrime(p, p)) ++c[0];
+        double t1 = now();
+        for (p = walkPrime(lo); p <= hi; p = walkPrime(p)) ++c[1];
+        double t2 = now();
+        printf("%6d %6d %9.2f %10.2f%s\n", rdigits[k], c[0],
+               1e3*(t1 - t0), 1e3*(t2 - t1), c[0] == c[1] ? "" : "  differs");
+    }
+}
+
+static void benchDiv()
+{
+    static const int digits[] = { 1000, 3000, 10000, 30000, 0 };
+
+    printf("div: ms per 2d by d digit divide, newton from %u limbs\n",
+           DIVNEWTON_THRESHOLD);
+    printf("digits     divBig   divKnuth\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        int d = digits[k];
+        Big* a = rndDigits(2*d);
+        Big* b = rndDigits(d);
+        Big* q;
+        Big* r;
+        int reps = repsFor((double)d*d/16);
+        int i;
+
+        double t0 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            q = divBig(a, b, &r);
+            destroyBig(q);
+            destroyBig(r);
+        }
+        double t1 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            q = _divKnuth(a, b, &r);
+            destroyBig(q);
+            destroyBig(r);
+        }
+        double t2 = now();
+
+        printf("%6d %10.3f %10.3f\n", d,
+               1e3*(t1 - t0)/reps, 1e3*(t2 - t1)/reps);
+
+        destroyBig(a);
+        destroyBig(b);
+    }
+}
+
+static void toNowhere(void* stream, char)
+{
+    ++*(unsigned int*)stream;
+}
+
+static void benchRadix()
+{
+    static const int digits[] = { 1000, 10000, 50000, 0 };
+
+    printf("radix: ms per conversion, split from %u limbs\n",
+           RADIX_DC_THRESHOLD);
+    printf("digits      print    print1      parse    parse1\n");
+    for (int k = 0; digits[k]; ++k)
+    {
+        int d = digits[k];
+        char* buf = new char[d + 1];
+        int i;
+        buf[0] = '1' + rnd() % 9;
+        for (i = 1; i < d; ++i) buf[i] = '0' + rnd() % 10;
+        buf[d] = 0;
+
+        const char* p = buf;
+        Big* a = parseBig(&p);
+        unsigned int n = 0;
+        int reps = repsFor((double)d*d/16);
+        double tm[4];
+
+        for (int m = 0; m < 2; ++m)
+        {
+            // the second time a digit group at a time
+            unsigned int rt = radixThreshold;
+            if (m) radixThreshold = ~0U/LIMBDIGITS;
+
+            double t0 = now();
+            for (i = 0; i < reps; ++i) asString(a, toNowhere, &n);
+            double t1 = now();
+            for (i = 0; i < reps; ++i)
+            {
+                p = buf;
+                destroyBig(parseBig(&p));
+            }
+            double t2 = now();
+
+            tm[m] = 1e3*(t1 - t0)/reps;
+            tm[m + 2] = 1e3*(t2 - t1)/reps;
+            radixThreshold = rt;
+        }
+        printf("%6d %10.3f %9.3f %10.3f %9.3f\n", d,
+               tm[0], tm[1], tm[2], tm[3]);
+
+        destroyBig(a);
+        delete [] buf;
+    }
+}
+
+static bool fracSum(int n, bool lazy, BigFrac* s)
+{
+    /* s = 1 + 1/2 + ... + 1/n */
+    BigFrac t, c;
+    bool ok = true;
+    setFracLazy(lazy ? lazyBits : 0);
+    s->x_ = constZero;
+    s->y_ = constOne;
+    for (int k = 1; ok && k <= n; ++k)
+    {
+        t.x_ = constOne;
+        t.y_ = createBig(k);
+        ok = addFrac(s, &t, &c);
+        destroyFrac(&t);
+        destroyFrac(s);
+        *s = c;
+    }
+    setFracLazy(0);
+    return ok && normFrac(s);
+}
+
+static bool fracCont(const int* a, int n, bool lazy, BigFrac* x)
+{
+    /* x = a0 + 1/(a1 + 1/(... + 1/an-1)) */
+    BigFrac t, c;
+    bool ok = true;
+    setFracLazy(lazy ? lazyBits : 0);
+    x->x_ = createBig(a[n-1]);
+    x->y_ = constOne;
+    for (int k = n - 2; ok && k >= 0; --k)
+    {
+        invertFrac(x);
+        t.x_ = createBig(a[k]);
+        t.y_ = constOne;
+        ok = addFrac(&t, x, &c);
+        destroyFrac(&t);
+        destroyFrac(x);
+        *x = c;
+    }
+    setFracLazy(0);
+    return ok && normFrac(x);
+}
+
+static void benchHarmonic()
+{
+    static const int terms[] = { 300, 1000, 3000, 0 };
+
+    printf("harmonic: ms per sum, lazy up to %u bits\n", lazyBits);
+    printf(" terms      eager       lazy\n");
+    for (int k = 0; terms[k]; ++k)
+    {
+        int n = terms[k];
+        BigFrac s[2];
+        double tm[2];
+        for (int m = 0; m < 2; ++m)
+        {
+            double t0 = now();
+            if (!fracSum(n, m != 0, &s[m])) s[m].x_ = s[m].y_ = 0;
+            tm[m] = 1e3*(now() - t0);
+        }
+        printf("%6d %10.2f %10.2f%s\n", n, tm[0], tm[1],
+               FRACOK(&s[0]) && FRACOK(&s[1]) && sameFrac(&s[0], &s[1])
+               ? "" : "  differs");
+        destroyFrac(&s[0]);
+        destroyFrac(&s[1]);
+    }
+}
+
+static void benchCfrac()
+{
+    static const int terms[] = { 1000, 3000, 10000, 0 };
+
+    printf("cfrac: ms per evaluation, lazy up to %u bits\n", lazyBits);
+    printf(" terms      eager       lazy\n");
+    for (int k = 0; terms[k]; ++k)
+    {
+        int n = terms[k];
+        int* a = new int[n];
+        for (int i = 0; i < n; ++i) a[i] = 1 + rnd() % 100;
+
+        BigFrac x[2];
+        double tm[2];
+        for (int m = 0; m < 2; ++m)
+        {
+            double t0 = now();
+            if (!fracCont(a, n, m != 0, &x[m])) x[m].x_ = x[m].y_ = 0;
+            tm[m] = 1e3*(now() - t0);
+        }
+        printf("%6d %10.2f %10.2f%s\n", n, tm[0], tm[1],
+               FRACOK(&x[0]) && FRACOK(&x[1]) && sameFrac(&x[0], &x[1])
+               ? "" : "  differs");
+        destroyFrac(&x[0]);
+        destroyFrac(&x[1]);
+        delete [] a;
+    }
+}
+
+static bool wanted(int argc, char** argv, const char* name)
+{
+    bool any = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strchr(argv[i], '=')) continue;
+        if (!strcmp(argv[i], name)) return true;
+        any = true;
+    }
+    return !any;
+}
+
+int main(int argc, char** argv)
+{
+    int i;
+    hostInit(100000);
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (!strncmp(argv[i], "k=", 2)) karatsubaThreshold = atoi(argv[i] + 2);
+        if (!strncmp(argv[i], "d=", 2)) divNewtonThreshold = atoi(argv[i] + 2);
+        if (!strncmp(argv[i], "r=", 2)) radixThreshold = atoi(argv[i] + 2);
+        if (!strncmp(argv[i], "z=", 2)) lazyBits = atoi(argv[i] + 2);
+    }
+
+    if (wanted(argc, argv, "tune")) benchTune();
+    if (wanted(argc, argv, "ops")) benchOps();
+    if (wanted(argc, argv, "prime")) benchPrime();
+    if (wanted(argc, argv, "ecm")) benchEcm();
+    if (wanted(argc, argv, "rho")) benchRho();
+    if (wanted(argc, argv, "nextprime")) benchNextPrime();
+    if (wanted(argc, argv, "div")) benchDiv();
+    if (wanted(argc, argv, "radix")) benchRadix();
+    if (wanted(argc, argv, "harmonic")) benchHarmonic();
+    if (wanted(argc, argv, "cfrac")) benchCfrac();
+
+    finishBig();
+    return 0;
+}
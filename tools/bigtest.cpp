@@ -0,0 +1,382 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only differential tests for mi.cpp, not part of the add-in.
+ *
+ * mi.cpp is included here so that the fast paths can be checked
+ * against its own schoolbook loops. build from this directory,
+ *
+ * g++ -O2 -I.. bigtest.cpp hoststub.cpp ../bigs.cpp ../big.cpp
+ *     ../bcdfloat.cpp ../bcd.cpp ../cutils.c -o bigtest
+ *
+ * add -DBIG_LIMBBITS=32 or 64 for wide limbs and, for example,
+ * -DKARATSUBA_THRESHOLD=4 so that small operands recurse deeply.
+ * likewise -DDIVNEWTON_THRESHOLD=5 and -DRADIX_DC_THRESHOLD=2 for
+ * the newton division and the split decimal conversions.
+ * exits non-zero if anything disagrees.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mi.cpp"
+#include "bigs.h"
+
+extern void hostInit(unsigned int maxDigits);
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    // xorshift, so runs repeat on every host
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static Big rndLimb()
+{
+    BigDouble v = rnd();
+    v = (v << 16) ^ rnd();
+    v = (v << 16) ^ rnd();
+    return (Big)v;
+}
+
+static Big* rndBig(unsigned int n, int mode)
+{
+    /* `n' limbs, random, all ones or mostly zero */
+    Big* b = _create(n);
+    unsigned int i;
+    for (i = 1; i <= n; ++i)
+    {
+        if (mode == 0) b[i] = rndLimb();
+        else if (mode == 1) b[i] = (Big)~0;
+        else b[i] = (rnd() & 3) ? 0 : rndLimb();
+    }
+    if (!b[n]) b[n] = 1;
+    SET_HEAD(b, 0, n);
+    return b;
+}
+
+static bool sameLimbs(Big* r, const Big* ref, unsigned int n)
+{
+    /* `r' against `n' bare limbs, ignoring leading zeros */
+    while (n > 1 && !ref[n-1]) --n;
+    if (DIGITS(r) != n) return false;
+    for (unsigned int i = 0; i < n; ++i)
+        if (r[i+1] != ref[i]) return false;
+    return true;
+}
+
+static int testMul(int iters, unsigned int maxLimbs)
+{
+    /* mulBig and sqrBig against _mulRaw and _sqrRaw */
+    int bad = 0;
+    Big* ref = new Big[2*maxLimbs];
+
+    for (int it = 0; it < iters; ++it)
+    {
+        unsigned int la = 1 + rnd() % maxLimbs;
+        unsigned int lb = (it % 3) ? 1 + rnd() % maxLimbs : la;
+        int mode = rnd() % 3;
+        Big* a = rndBig(la, mode);
+        Big* b = rndBig(lb, mode);
+
+        Big* r = mulBig(a, b);
+        _mulRaw(a + 1, la, b + 1, lb, ref);
+        if (!r || !sameLimbs(r, ref, la + lb))
+        {
+            if (++bad < 5) printf("mul %u x %u limbs differs\n", la, lb);
+        }
+        destroyBig(r);
+
+        r = sqrBig(a);
+        _sqrRaw(a + 1, la, ref);
+        if (!r || !sameLimbs(r, ref, 2*la))
+        {
+            if (++bad < 5) printf("sqr %u limbs differs\n", la);
+        }
+        destroyBig(r);
+        destroyBig(a);
+        destroyBig(b);
+    }
+    delete [] ref;
+    return bad;
+}
+
+static Big* gcdEuclid(Big* a, Big* b)
+{
+    /* plain euclid by remainders, a > 0, b > 0 */
+    Big* u = copyBig(a);
+    Big* v = copyBig(b);
+    Big* r;
+    while (!ISZERO(v))
+    {
+        destroyBig(divBig(u, v, &r));
+        destroyBig(u);
+        u = v;
+        v = r;
+    }
+    destroyBig(v);
+    return u;
+}
+
+static int testGcd(int iters, unsigned int maxLimbs)
+{
+    /* gcdBig against euclid, with a planted common factor */
+    int bad = 0;
+    for (int it = 0; it < iters; ++it)
+    {
+        Big* g = rndBig(1 + rnd() % (maxLimbs/2), 0);
+        Big* x = rndBig(1 + rnd() % maxLimbs, rnd() % 3);
+        Big* y = rndBig(1 + rnd() % maxLimbs, rnd() % 3);
+        Big* a = mulBig(g, x);
+        Big* b = mulBig(g, y);
+
+        Big* r = gcdBig(a, b);
+        Big* ref = gcdEuclid(a, b);
+        if (!r || compare(r, ref))
+        {
+            if (++bad < 5) printf("gcd %u, %u limbs differs\n",
+                                  DIGITS(a), DIGITS(b));
+        }
+        destroyBig(r);
+        destroyBig(ref);
+        destroyBig(a);
+        destroyBig(b);
+        destroyBig(g);
+        destroyBig(x);
+        destroyBig(y);
+    }
+    return bad;
+}
+
+static Big* powerModRef(Big* b, Big* e, Big* m)
+{
+    /* right to left binary powering with mulBigMod */
+    Big* y = createBig(1);
+    Big* x = copyBig(b);
+    Big* t;
+    unsigned int n = _bitlength(e);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        if ((e[1 + (i >> BASEBITSBITS)] >> (i & (BASEBITS-1))) & 1)
+        {
+            t = mulBigMod(y, x, m);
+            destroyBig(y);
+            y = t;
+        }
+        t = mulBigMod(x, x, m);
+        destroyBig(x);
+        x = t;
+    }
+    destroyBig(x);
+    return y;
+}
+
+static int testPowerMod(int iters, unsigned int maxLimbs)
+{
+    /* powerBigMod, montgomery for odd moduli, against plain powering */
+    int bad = 0;
+    for (int it = 0; it < iters; ++it)
+    {
+        Big* m = rndBig(1 + rnd() % maxLimbs, rnd() % 3);
+        Big* e = rndBig(1 + rnd() % 4, 0);
+        Big* a = rndBig(1 + rnd() % maxLimbs, 0);
+        Big* b;
+        destroyBig(divBig(a, m, &b));
+
+        Big* r = powerBigMod(b, e, m);
+        Big* ref = powerModRef(b, e, m);
+        if (!r || compare(r, ref))
+        {
+            if (++bad < 5) printf("powmod %u limb modulus differs\n",
+                                  DIGITS(m));
+        }
+        destroyBig(r);
+        destroyBig(ref);
+        destroyBig(a);
+        destroyBig(b);
+        destroyBig(e);
+        destroyBig(m);
+    }
+    return bad;
+}
+
+static int testPrime(int iters)
+{
+    /* baillie-psw and the witness loop must agree */
+    static const char* known[] =
+    {
+        "561", "2047", "3215031751", "3825123056546413051",
+        "318665857834031151167461", "2305843009213693951",
+        "170141183460469231731687303715884105727",
+        "170141183460469231731687303715884105729",
+        0
+    };
+
+    int bad = 0;
+    int i, k = 0;
+    for (i = 0; i < iters; ++i)
+    {
+        Big* n;
+        if (known[k])
+        {
+            const char* p = known[k++];
+            n = parseBig(&p);
+        }
+        else
+        {
+            // odd, up to 128 bits
+            n = rndBig(1 + rnd() % (128/BASEBITS), 0);
+            n[1] |= 1;
+        }
+
+        BigInt v(n);
+        setPrimeTest(PRIMETEST_BPSW);
+        int p1 = isPrime(v);
+        setPrimeTest(PRIMETEST_WITNESS);
+        int p2 = isPrime(v);
+        if (p1 != p2)
+        {
+            if (++bad < 5) printf("prime tests disagree at %u limbs\n",
+                                  DIGITS(n));
+        }
+    }
+    setPrimeTest(PRIMETEST_BPSW);
+    return bad;
+}
+
+static int testDiv(int iters)
+{
+    /* divBig, newton once both sides are long, against algorithm D */
+    int bad = 0;
+    unsigned int span = 2*DIVNEWTON_THRESHOLD;
+    for (int it = 0; it < iters; ++it)
+    {
+        unsigned int lb = 1 + rnd() % span;
+        unsigned int la = lb + rnd() % span;
+        Big* a = rndBig(la, rnd() % 3);
+        Big* b = rndBig(lb, rnd() % 3);
+        if (rnd() & 1) a = negateBig(a);
+        if (rnd() & 1) b = negateBig(b);
+
+        Big* r;
+        Big* rr;
+        Big* q = divBig(a, b, &r);
+        Big* qq = _divKnuth(a, b, &rr);
+        if (!q || !qq || compare(q, qq) || compare(r, rr))
+        {
+            if (++bad < 5) printf("div %u by %u limbs differs\n", la, lb);
+        }
+        destroyBig(q);
+        destroyBig(r);
+        destroyBig(qq);
+        destroyBig(rr);
+        destroyBig(a);
+        destroyBig(b);
+    }
+    return bad;
+}
+
+struct StrSink
+{
+    char*       _p;
+    char*       _end;
+};
+
+static void toSink(void* stream, char c)
+{
+    StrSink* s = (StrSink*)stream;
+    if (s->_p < s->_end) *s->_p++ = c;
+}
+
+static int testRadix(int iters)
+{
+    /* asString then parseBig must give the number back */
+    int bad = 0;
+    unsigned int span = 4*RADIX_DC_THRESHOLD;
+    unsigned int size = span*LIMBDIGITS + 2;
+    char* buf = new char[size + 1];
+    for (int it = 0; it < iters; ++it)
+    {
+        unsigned int n = 1 + rnd() % span;
+        Big* a = rndBig(n, rnd() % 3);
+        if (rnd() & 1) a = negateBig(a);
+
+        StrSink s;
+        s._p = buf;
+        s._end = buf + size;
+        asString(a, toSink, &s);
+        *s._p = 0;
+
+        const char* p = buf;
+        Big* b = parseBig(&p);
+        if (!b || *p || compare(a, b))
+        {
+            if (++bad < 5) printf("radix %u limbs differs\n", n);
+        }
+        destroyBig(b);
+        destroyBig(a);
+    }
+    delete [] buf;
+    return bad;
+}
+
+int main(int argc, char** argv)
+{
+    int iters = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned int maxLimbs = 4096/BASEBITS;
+    int bad, total = 0;
+
+    hostInit(100000);
+    printf("%d bit limbs, karatsuba from %d limbs\n",
+           BASEBITS, KARATSUBA_THRESHOLD);
+
+    bad = testMul(iters, maxLimbs);
+    printf("mul/sqr  %d bad\n", bad);
+    total += bad;
+
+    bad = testGcd(iters, maxLimbs);
+    printf("gcd      %d bad\n", bad);
+    total += bad;
+
+    bad = testPowerMod(iters/10, maxLimbs/2);
+    printf("powmod   %d bad\n", bad);
+    total += bad;
+
+    bad = testPrime(iters);
+    printf("prime    %d bad\n", bad);
+    total += bad;
+
+    bad = testDiv(iters/10);
+    printf("div      %d bad\n", bad);
+    total += bad;
+
+    bad = testRadix(iters/10);
+    printf("radix    %d bad\n", bad);
+    total += bad;
+
+    finishBig();
+    return total != 0;
+}
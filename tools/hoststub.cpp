@@ -0,0 +1,51 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* the little the big number code needs from the rest of the
+ * calculator, so that the host tools link without types.cpp.
+ */
+
+#include "types.h"
+#include "calc.h"
+
+Calc* Calc::theCalc;
+
+TermContext::TermContext() {}
+void TermRef::purge() {}
+
+/* there is no keyboard. escape reads a flag instead, so that one
+ * worker can stop the others, see parfactor.
+ */
+int hostStop;
+
+extern "C" int EscapeKeyPressed()
+{
+    return __atomic_load_n(&hostStop, __ATOMIC_RELAXED);
+}
+
+void hostInit(unsigned int maxDigits)
+{
+    Calc::theCalc = new Calc;
+    Calc::theCalc->setMaxDigits(maxDigits);
+    InitBig();
+}
@@ -0,0 +1,377 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only timings for mat.cpp, not part of the add-in. mat.cpp is
+ * included so that its static kernels can be timed directly, the
+ * rest of the calculator is linked for the array terms. build from
+ * this directory,
+ *
+ * g++ -O2 -I.. matbench.cpp ../types.cpp ../calc.cpp ../symbol.cpp
+ *     ../eeval.cpp ../solve.cpp ../finance.cpp ../dlist.cpp
+ *     ../complex.cpp ../complex2.cpp ../bigs.cpp ../big.cpp ../mi.cpp
+ *     ../int64.cpp ../bcdv.cpp ../bcdmath.cpp ../bcdfloat2.cpp
+ *     ../bcdfloat.cpp ../bcd.cpp ../cutils.c -o matbench
+ *
+ * the sections are
+ *
+ * dense  ms per LU, inverse, determinant and SVD at n = 10, 50 and
+ *        200, and for the copy to and from array terms that each of
+ *        them starts and ends with. the svd at 200 alone takes
+ *        over a minute.
+ * matmul ms per product, the plain triple loop against the tiled
+ *        matMul, and whether the two agree to the last digit.
+ * lu     ms per luDecomp unblocked, and in panels of LU_BLOCK, by n.
+ * cache  ms per solve of a.x = b for new `b' against the same `a',
+ *        reusing the cached factors and factoring afresh each time.
+ * svd    seconds per svdJacobi of a square matrix, n = 16 to 256,
+ *        and the largest element of a - u.diag(w).v^T relative to
+ *        the largest singular value. 256 alone takes minutes.
+ *
+ * give section names to run only those, otherwise all run. t=<n>
+ * runs the rest with matMul tiles of n, b=<n> with LU panels of n
+ * columns.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* the tile and panel sizes are variables here, so that they can be
+ * changed between runs. they start at the mat.cpp defaults.
+ */
+static unsigned int matmulTile = 16;
+#define MATMUL_TILE     matmulTile
+static int luBlock = 8;
+#define LU_BLOCK        luBlock
+
+#include "mat.cpp"
+#include "calc.h"
+
+// the little of the device the linked calculator calls
+extern "C" int EscapeKeyPressed() { return 0; }
+extern "C" void CPUSpeedFast() {}
+extern "C" void CPUSpeedNormal() {}
+void PlotGraph(Term*, BCD&, BCD&) {}
+void PlotGraph3D(Term*, const BCD&, const BCD&, const BCD&, const BCD&,
+                 const BCD&) {}
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static double now()
+{
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static void rndMat(Mat& a, unsigned int m, unsigned int n)
+{
+    /* entries in -10..10 to three places, almost surely regular */
+    a.resize(m, n);
+    for (unsigned int i = 0; i < m*n; ++i)
+        a._d[i] = VALUE((int4)(rnd() % 20001) - 10000)/VALUE(1000);
+}
+
+static int repsFor(double n3)
+{
+    /* repeats so that an n^3 operation takes a measurable time */
+    int r = (int)(2e6/n3);
+    return r < 1 ? 1 : r;
+}
+
+static void benchDense()
+{
+    static const unsigned int sizes[] = { 10, 50, 200, 0 };
+
+    printf("dense: ms per op\n");
+    printf("  n    array       lu      inv      det      svd\n");
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Mat ad;
+        rndMat(ad, n, n);
+        Matrix a;
+        Matrix::_create(a, ad);
+
+        int reps = repsFor((double)n*n*n);
+        int* indx = new int[n];
+        int i, d;
+
+        double t0 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            Mat t;
+            Matrix c;
+            a.toDense(t);
+            Matrix::_create(c, t);
+        }
+        double t1 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            Mat t;
+            t.copy(ad);
+            luDecomp(t, n, indx, &d);
+        }
+        double t2 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            Matrix c;
+            bool singular;
+            LUFactorization::clearCache();
+            invert(a, c, singular);
+        }
+        double t3 = now();
+        for (i = 0; i < reps; ++i)
+        {
+            VALUE det;
+            LUFactorization::clearCache();
+            a.determinant(det);
+        }
+        double t4 = now();
+
+        // svd is many times the rest, fewer goes
+        int sreps = reps/8 + 1;
+        for (i = 0; i < sreps; ++i)
+        {
+            Matrix u, w, v;
+            a.svd(u, w, v);
+        }
+        double t5 = now();
+
+        printf("%3u %8.3f %8.3f %8.3f %8.3f %8.3f\n", n,
+               1e3*(t1 - t0)/reps, 1e3*(t2 - t1)/reps,
+               1e3*(t3 - t2)/reps, 1e3*(t4 - t3)/reps,
+               1e3*(t5 - t4)/sreps);
+
+        delete [] indx;
+        LUFactorization::clearCache();
+    }
+}
+
+static void mulPlain(const Mat& a, const Mat& b,
+                     unsigned int m, unsigned int n, unsigned int l, Mat& c)
+{
+    /* the triple loop matMul replaced */
+    unsigned int i, j, k;
+    for (i = 0; i < m; ++i)
+        for (j = 0; j < l; ++j)
+        {
+            VALUE s = 0;
+            for (k = 0; k < n; ++k) s += MAT(a,n,i,k)*MAT(b,l,k,j);
+            MAT(c,l,i,j) = s;
+        }
+}
+
+static bool sameMat(const Mat& a, const Mat& b)
+{
+    for (unsigned int i = 0; i < a._nRows*a._nCols; ++i)
+        if (memcmp(&a._d[i]._v, &b._d[i]._v, sizeof(BCDFloat))) return false;
+    return true;
+}
+
+static int benchMatMul()
+{
+    static const unsigned int sizes[] = { 32, 64, 128, 200, 0 };
+    int bad = 0;
+
+    printf("matmul: ms per product, tiles of %u\n", MATMUL_TILE);
+    printf("  n    plain    tiled  same\n");
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Mat a, b;
+        rndMat(a, n, n);
+        rndMat(b, n, n);
+        Mat c1(n, n), c2(n, n);
+
+        int reps = repsFor((double)n*n*n);
+        int i;
+        double t0 = now();
+        for (i = 0; i < reps; ++i) mulPlain(a, b, n, n, n, c1);
+        double t1 = now();
+        for (i = 0; i < reps; ++i) matMul(a, b, n, n, n, c2);
+        double t2 = now();
+
+        bool same = sameMat(c1, c2);
+        if (!same) ++bad;
+        printf("%3u %8.3f %8.3f  %s\n", n,
+               1e3*(t1 - t0)/reps, 1e3*(t2 - t1)/reps, same ? "yes" : "NO");
+    }
+    return bad;
+}
+
+static void benchLU()
+{
+    static const unsigned int sizes[] = { 25, 50, 100, 200, 0 };
+
+    printf("lu: ms per decomposition\n");
+    printf("  n  block 1  block %d\n", LU_BLOCK);
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Mat a;
+        rndMat(a, n, n);
+        int* indx = new int[n];
+        int reps = repsFor((double)n*n*n);
+        double tm[2];
+        int b = luBlock;
+        int i, d;
+
+        for (int m = 0; m < 2; ++m)
+        {
+            luBlock = m ? b : 1;
+            double t0 = now();
+            for (i = 0; i < reps; ++i)
+            {
+                Mat t;
+                t.copy(a);
+                luDecomp(t, n, indx, &d);
+            }
+            tm[m] = (now() - t0)/reps;
+        }
+        luBlock = b;
+        printf("%3u %8.3f %8.3f\n", n, 1e3*tm[0], 1e3*tm[1]);
+        delete [] indx;
+    }
+}
+
+static void benchCache()
+{
+    static const unsigned int sizes[] = { 10, 50, 100, 0 };
+    const int nb = 20;
+
+    printf("cache: ms per solve, %d right hand sides\n", nb);
+    printf("  n   cached  refactor\n");
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Mat ad;
+        rndMat(ad, n, n);
+        Matrix a;
+        Matrix::_create(a, ad);
+
+        Matrix b[nb];
+        int i;
+        for (i = 0; i < nb; ++i)
+        {
+            Mat bd;
+            rndMat(bd, n, 1);
+            Matrix::_create(b[i], bd);
+        }
+
+        double tm[2];
+        for (int m = 0; m < 2; ++m)
+        {
+            LUFactorization::clearCache();
+            double t0 = now();
+            for (i = 0; i < nb; ++i)
+            {
+                Matrix x;
+                if (m) LUFactorization::clearCache();
+                div(b[i], a, x);
+            }
+            tm[m] = (now() - t0)/nb;
+        }
+        printf("%3u %8.3f %9.3f\n", n, 1e3*tm[0], 1e3*tm[1]);
+        LUFactorization::clearCache();
+    }
+}
+
+static int benchSvd()
+{
+    static const unsigned int sizes[] = { 16, 32, 64, 128, 256, 0 };
+    int bad = 0;
+
+    printf("svd: seconds per decomposition\n");
+    printf("  n  seconds  residual\n");
+    for (int k = 0; sizes[k]; ++k)
+    {
+        unsigned int n = sizes[k];
+        Mat a, u, v(n, n), w(1, n);
+        rndMat(a, n, n);
+        u.copy(a);
+
+        double t0 = now();
+        svdJacobi(u, n, n, w._d, v);
+        double t = now() - t0;
+
+        VALUE r = 0;
+        unsigned int i, j, c;
+        for (i = 0; i < n; ++i)
+            for (j = 0; j < n; ++j)
+            {
+                VALUE s = MAT(a,n,i,j);
+                for (c = 0; c < n; ++c)
+                    s -= MAT(u,n,i,c)*w._d[c]*MAT(v,n,j,c);
+                if (fabs(s) > r) r = fabs(s);
+            }
+        r /= w._d[0];
+
+        // some twenty digits survive the rotations
+        if (r > BCD::epsilon(18)) ++bad;
+        printf("%3u %8.2f  %s\n", n, t, r.asStringFmt(BCDFloat::format_scimode, 3));
+    }
+    return bad;
+}
+
+static bool wanted(int argc, char** argv, const char* name)
+{
+    bool any = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strchr(argv[i], '=')) continue;
+        if (!strcmp(argv[i], name)) return true;
+        any = true;
+    }
+    return !any;
+}
+
+int main(int argc, char** argv)
+{
+    int i;
+    int bad = 0;
+    Calc::theCalc = new Calc;
+    Calc::theCalc->start();
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (!strncmp(argv[i], "t=", 2)) matmulTile = atoi(argv[i] + 2);
+        if (!strncmp(argv[i], "b=", 2)) luBlock = atoi(argv[i] + 2);
+    }
+
+    if (wanted(argc, argv, "dense")) benchDense();
+    if (wanted(argc, argv, "matmul")) bad += benchMatMul();
+    if (wanted(argc, argv, "lu")) benchLU();
+    if (wanted(argc, argv, "cache")) benchCache();
+    if (wanted(argc, argv, "svd")) bad += benchSvd();
+
+    // non-zero if the tiled product differs or the svd is inexact
+    return bad != 0;
+}
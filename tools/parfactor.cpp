@@ -0,0 +1,241 @@
+/**
+ *
+ * Copyright (c) 2010-2015 Voidware Ltd.  All Rights Reserved.
+ *
+ * This file contains Original Code and/or Modifications of Original Code as
+ * defined in and that are subject to the Voidware Public Source Licence version
+ * 1.0 (the 'Licence'). You may not use this file except in compliance with the
+ * Licence or with expressly written permission from Voidware.  Please obtain a
+ * copy of the Licence at http://www.voidware.com/legal/vpsl1.txt and read it
+ * before using this file.
+ *
+ * The Original Code and all software distributed under the Licence are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS
+ * OR IMPLIED, AND VOIDWARE HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING
+ * WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ *
+ * Please see the Licence for the specific language governing rights and
+ * limitations under the Licence.
+ *
+ * contact@voidware.com
+ */
+
+/* host only parallel factoring, not part of the add-in.
+ * build from this directory,
+ *
+ * g++ -O2 -pthread -I.. parfactor.cpp hoststub.cpp ../mi.cpp
+ *     ../bigs.cpp ../big.cpp ../bcdfloat.cpp ../bcd.cpp ../cutils.c
+ *     -o parfactor
+ *
+ * parfactor [ecm|rho] [j=<n>] [number ...]
+ *
+ * j workers split the ECM curves, or the rho walks, by `first' and
+ * `step', so they try what one worker would, j at a time. the first
+ * to find a factor raises the stop flag, which the others see as
+ * the escape key. with no numbers, semiprimes are timed against the
+ * number of workers, 1 up to j. times are wall clock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "mi.h"
+#include "big.h"
+#include "bigs.h"
+
+extern void hostInit(unsigned int maxDigits);
+extern int hostStop;
+
+#define MAX_WORKERS     64
+#define ECM_CURVES      500
+#define RHO_TRIALS      20000000
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int rnd()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int)seed;
+}
+
+static double now()
+{
+    // the workers all count towards clock(), so use the wall
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+struct Job
+{
+    const BigInt*       _n;
+    bool                _ecm;
+    int                 _first;
+    int                 _step;
+    Big*                _f;         // factor found, or 0
+};
+
+static void* work(void* arg)
+{
+    Job* j = (Job*)arg;
+    j->_f = 0;
+    if (j->_ecm)
+    {
+        BigInt f;
+        if (Lenstra(*j->_n, f, ECM_CURVES, j->_first, j->_step)
+            && f != 1 && f != *j->_n)
+            j->_f = f.give();
+    }
+    else
+    {
+        // a copy of our own, walks start at c = 1
+        unsigned int tr = RHO_TRIALS;
+        Big* n = BigInt(*j->_n).give();
+        j->_f = pollardRho(n, 2, &tr, j->_first + 1, j->_step);
+        destroyBig(n);
+    }
+
+    // stop the rest
+    if (j->_f) __atomic_store_n(&hostStop, 1, __ATOMIC_RELAXED);
+    finishBigThread();
+    return 0;
+}
+
+static Big* factor(const BigInt& n, bool ecm, int nw)
+{
+    /* a proper factor of n by `nw' workers, 0 if none found */
+    pthread_t th[MAX_WORKERS];
+    Job jobs[MAX_WORKERS];
+    Big* f = 0;
+    int i;
+
+    hostStop = 0;
+    for (i = 0; i < nw; ++i)
+    {
+        jobs[i]._n = &n;
+        jobs[i]._ecm = ecm;
+        jobs[i]._first = i;
+        jobs[i]._step = nw;
+        pthread_create(&th[i], 0, work, &jobs[i]);
+    }
+    for (i = 0; i < nw; ++i)
+    {
+        pthread_join(th[i], 0);
+        if (jobs[i]._f)
+        {
+            // keep the first, any others are dropped
+            if (!f) f = jobs[i]._f;
+            else destroyBig(jobs[i]._f);
+        }
+    }
+    hostStop = 0;
+    return f;
+}
+
+static void streamOut(void*, char c)
+{
+    putchar(c);
+}
+
+static BigInt rndPrime(int d)
+{
+    /* next prime after a random `d' digit number */
+    char buf[64];
+    int i;
+    buf[0] = '1' + rnd() % 9;
+    for (i = 1; i < d; ++i) buf[i] = '0' + rnd() % 10;
+    buf[d] = 0;
+
+    const char* p = buf;
+    BigInt p0(parseBig(&p));
+    BigInt np;
+    nextPrime(p0, np);
+    return np;
+}
+
+static void timing(bool ecm, int nw)
+{
+    /* semiprimes p.q with p of a few sizes, q of 25 digits */
+    static const int ecmDigits[] = { 10, 12, 14, 0 };
+    static const int rhoDigits[] = { 8, 9, 10, 0 };
+    const int* digits = ecm ? ecmDigits : rhoDigits;
+    const int per = 3;
+
+    printf("%s: wall seconds per factor of p.q, q of 25 digits\n",
+           ecm ? "ecm" : "rho");
+    printf("digits");
+    for (int w = 1; w <= nw; w <<= 1) printf("  j=%-5d", w);
+    printf("\n");
+
+    for (int k = 0; digits[k]; ++k)
+    {
+        BigInt ns[per];
+        int i;
+        for (i = 0; i < per; ++i) ns[i] = rndPrime(digits[k])*rndPrime(25);
+
+        printf("%6d", digits[k]);
+        for (int w = 1; w <= nw; w <<= 1)
+        {
+            int found = 0;
+            double t0 = now();
+            for (i = 0; i < per; ++i)
+            {
+                Big* f = factor(ns[i], ecm, w);
+                if (f) ++found;
+                destroyBig(f);
+            }
+            printf(" %7.2f%s", (now() - t0)/per, found == per ? " " : "?");
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool ecm = true;
+    int nw = 4;
+    int nums = 0;
+    int i;
+
+    hostInit(100000);
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "ecm")) ecm = true;
+        else if (!strcmp(argv[i], "rho")) ecm = false;
+        else if (!strncmp(argv[i], "j=", 2)) nw = atoi(argv[i] + 2);
+    }
+    if (nw < 1) nw = 1;
+    if (nw > MAX_WORKERS) nw = MAX_WORKERS;
+
+    for (i = 1; i < argc; ++i)
+    {
+        const char* p = argv[i];
+        if (*p < '0' || *p > '9') continue;
+
+        ++nums;
+        BigInt n(parseBig(&p));
+        double t0 = now();
+        Big* f = factor(n, ecm, nw);
+        double t = now() - t0;
+
+        if (f)
+        {
+            asString(f, streamOut, 0);
+            destroyBig(f);
+        }
+        else printf("no factor");
+        printf("  (%.2fs)\n", t);
+    }
+
+    if (!nums) timing(ecm, nw);
+
+    finishBig();
+    return 0;
+}
@@ -36,6 +36,8 @@
 #include "bigs.h"
 #include "nran.h"
 #include "cutils.h"
+#include "calc.h"
+#include "bcdv.h"
 
 #ifdef _WIN32
 #include "oswin.h"
@@ -1599,6 +1601,41 @@ bool Array::reduce(TermRef& res, TermContext& tc)
     return false; // finished reducing
 }
 
+/** SparseMatrix *********************************************/
+
+SparseMatrix* SparseMatrix::create(unsigned int nRows,
+                                   unsigned int nCols,
+                                   unsigned int nnz)
+{
+    SparseMatrix* s = new SparseMatrix;
+    s->nRows_ = nRows;
+    s->nCols_ = nCols;
+    s->nnz_ = nnz;
+    s->rows_ = new unsigned int[nRows+1];
+    s->cols_ = new unsigned short[nnz ? nnz : 1];
+    s->vals_ = new BCD[nnz ? nnz : 1];
+    return s;
+}
+
+static void streamUint(TermRef& s, unsigned int v)
+{
+    Big* b = createBigu(v);
+    if (b) asString(b, streamChar, &s);
+    destroyBig(b);
+}
+
+void SparseMatrix::asString(TermRef& s, DispFormat*) const
+{
+    // too big to show, give the shape instead
+    STRING(s)->append("[sparse ");
+    streamUint(s, nRows_);
+    STRING(s)->append('x');
+    streamUint(s, nCols_);
+    STRING(s)->append(", ");
+    streamUint(s, nnz_);
+    STRING(s)->append(']');
+}
+
 /** RegInfo **************************************************/
 
 RegInfo* RegInfo::create(Symbol* s, Type rt, int nargs, ...)
@@ -2079,7 +2116,7 @@ void factorRational(TermRef& res, Rational* a)
 void isPrimeRational(TermRef& res, Rational* a)
 {
     int v = 0; // not prime
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         // dont allow this to be destroyed as it's owned 
         BigInt t(a->rat_.x_);
@@ -2091,7 +2128,7 @@ void isPrimeRational(TermRef& res, Rational* a)
 
 void nextPrimeRational(TermRef& res, Rational* a)
 {
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         // dont allow this to be destroyed as it's owned 
         BigInt t(a->rat_.x_);
@@ -2104,7 +2141,7 @@ void nextPrimeRational(TermRef& res, Rational* a)
 
 void prevPrimeRational(TermRef& res, Rational* a)
 {
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         // dont allow this to be destroyed as it's owned 
         BigInt t(a->rat_.x_);
@@ -2115,10 +2152,111 @@ void prevPrimeRational(TermRef& res, Rational* a)
     }
 }
 
+void primeTestRational(TermRef& res, Rational* a)
+{
+    /* choose the prime test, 0 for baillie-psw or 1 for the
+     * witness loop. answer the old one.
+     */
+    if (isIntFrac(&a->rat_) && !isNeg(a->rat_.x_) && log2(a->rat_.x_) < 8)
+    {
+        int m = bigAsInt(a->rat_.x_);
+        if (m == PRIMETEST_BPSW || m == PRIMETEST_WITNESS)
+            res = Rational::create(setPrimeTest(m));
+    }
+}
+
+void digitsRational(TermRef& res, Rational* a)
+{
+    /* set the limit on exact integers, answer the old limit.
+     * fails below 32 digits.
+     */
+    if (isIntFrac(&a->rat_) && !isNeg(a->rat_.x_) && log2(a->rat_.x_) < 24)
+    {
+        Calc* c = Calc::theCalc;
+        int d = bigAsInt(a->rat_.x_);
+        if (d >= 32)
+        {
+            res = Rational::create(c->_maxDecimalDigits);
+            c->setMaxDigits(d);
+        }
+    }
+}
+
+void precRational(TermRef& res, Rational* a)
+{
+    /* set the digits of the `v' functions, answer the old value.
+     * fails outside 8 to BCDV_USER_DIGITS.
+     */
+    if (isIntFrac(&a->rat_) && !isNeg(a->rat_.x_) && log2(a->rat_.x_) < 16)
+    {
+        int d = bigAsInt(a->rat_.x_);
+        if (d >= 8 && d <= BCDV_USER_DIGITS)
+            res = Rational::create(BCDV::setDigits(d));
+    }
+}
+
+void lazyRational(TermRef& res, Rational* a)
+{
+    /* leave fraction results unreduced until a part is over this
+     * many bits, 0 to always reduce. answer the old value.
+     */
+    if (isIntFrac(&a->rat_) && !isNeg(a->rat_.x_) && log2(a->rat_.x_) < 24)
+        res = Rational::create((long)setFracLazy(bigAsUint(a->rat_.x_)));
+}
+
+/* the `v' functions work at `prec' digits. they answer a string
+ * because no number term holds that many, and take one back so
+ * that results can be chained.
+ */
+static BCDV vArg(Term* a)
+{
+    if (ISSTRING(a))
+    {
+        const char* s = ((String*)a)->s_;
+        return BCDV(s ? s : "");
+    }
+    return BCDV(((Float*)a)->v_);
+}
+
+static void vResult(TermRef& res, const BCDV& v)
+{
+    if (v.isNan()) return;
+
+    char* buf = new char[BCDV::digits() + 16];
+    v.asString(buf);
+    String* s = String::create();
+    s->append(buf);
+    res = s;
+    delete [] buf;
+}
+
+void vexpFn(TermRef& res, Term* a) { vResult(res, exp(vArg(a))); }
+void vlnFn(TermRef& res, Term* a) { vResult(res, log(vArg(a))); }
+void vsqrtFn(TermRef& res, Term* a) { vResult(res, sqrt(vArg(a))); }
+void vsinFn(TermRef& res, Term* a) { vResult(res, sin(vArg(a))); }
+void vcosFn(TermRef& res, Term* a) { vResult(res, cos(vArg(a))); }
+void vatanFn(TermRef& res, Term* a) { vResult(res, atan(vArg(a))); }
+void vfacFn(TermRef& res, Term* a) { vResult(res, gammaFactorial(vArg(a))); }
+
+void memStatArray(TermRef& res)
+{
+    /* [allocations heap-allocations peak-bytes] since last asked */
+    BigAllocStats st;
+    bigAllocStats(&st);
+    resetBigAllocStats();
+
+    Array* a = Array::create(3);
+    a->_at(0) = Rational::create((long)st.allocs_);
+    a->_at(1) = Rational::create((long)st.heapAllocs_);
+    a->_at(2) = Rational::create((long)st.peakBytes_);
+    a->_initFlags();
+    res = a;
+}
+
 void sqRational(TermRef& res, Rational* a)
 {
     BigFrac c;
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         Big* b = sqrBig(a->rat_.x_);
         if (b)
@@ -2149,7 +2287,7 @@ void sqrtRational(TermRef& res, Rational* a)
 
 void nRootRational(TermRef& res, Rational* a, Rational* r)
 {
-    if (ISONE(r->rat_.y_))
+    if (isIntFrac(&r->rat_))
     {
         unsigned int k = bigAsUint(r->rat_.x_);
         if (k > 0 && k != (unsigned int)-1)
@@ -2163,7 +2301,7 @@ void nRootRational(TermRef& res, Rational* a, Rational* r)
 
 void ranRational(TermRef& res, Rational* a)
 {
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         unsigned int n = bigAsUint(a->rat_.x_);
         res = Rational::create((ranq.int32() % n) + 1);
@@ -2172,7 +2310,7 @@ void ranRational(TermRef& res, Rational* a)
 
 void sranRational(TermRef& res, Rational* a)
 {
-    if (ISONE(a->rat_.y_))
+    if (isIntFrac(&a->rat_))
     {
         unsigned int n = bigAsUint(a->rat_.x_);
         nran.seed(n); // also seeds ranq
@@ -2182,7 +2320,7 @@ void sranRational(TermRef& res, Rational* a)
 
 void nranRational(TermRef& res, Rational* a, Rational* b)
 {
-    if (ISONE(a->rat_.y_) && ISONE(b->rat_.y_))
+    if (isIntFrac(&a->rat_) && isIntFrac(&b->rat_))
     {
         unsigned int n = bigAsUint(a->rat_.x_);
         unsigned int m = bigAsUint(b->rat_.x_);
@@ -2510,9 +2648,94 @@ void quoteExpr(TermRef& res, Term* t)
 
 /** Array *******************************************************/
 
-void opArrayScalar(TermRef& res, Array* a, Number* b, TermRef sym)
+static bool opArrayScalarN(TermRef& res, Array* a, Number* b, char op)
+{
+    /* apply op elementwise over a numeric vector or matrix directly,
+     * without building and reducing a function term per element.
+     * return false if any element is not a float or complex.
+     */
+    if (!a->isVecMat()) return false;
+
+    bool cb = false;
+    if (b)
+    {
+        if (ISCOMPLEX(b)) cb = true;
+        else if (!ISFLOAT(b)) return false;
+    }
+
+    unsigned int i;
+    Array* newA = Array::create(a->size());
+    TermRef r(newA);
+    for (i = 0; i < a->size(); ++i) 
+    {
+        TermRef& t = a->_at(i);
+        if (ISARRAY(t))
+        {
+            // matrix row
+            if (!opArrayScalarN(newA->_at(i), ARRAY(t), b, op)) 
+                return false;
+        }
+        else if (ISFLOAT(t) && !cb)
+        {
+            const DPD& x = FLOAT(t)->v_;
+            if (!b) newA->_at(i) = Float::create(-x);
+            else
+            {
+                const DPD& y = F(b)->v_;
+                switch (op)
+                {
+                case '+': newA->_at(i) = Float::create(x + y); break;
+                case '-': newA->_at(i) = Float::create(x - y); break;
+                case '*': newA->_at(i) = Float::create(x * y); break;
+                case '/': newA->_at(i) = Float::create(x / y); break;
+                }
+            }
+        }
+        else if (ISFLOAT(t) || ISCOMPLEX(t))
+        {
+            Complex x;
+            if (ISFLOAT(t)) x = Complex(FLOAT(t)->v_.asBCD());
+            else x = COMPLEX(t)->cmf_;
+
+            if (!b) newA->_at(i) = ComplexN::create(-x);
+            else
+            {
+                Complex y;
+                if (cb) y = ((ComplexN*)b)->cmf_;
+                else y = Complex(F(b)->v_.asBCD());
+
+                switch (op)
+                {
+                case '+': x += y; break;
+                case '-': x -= y; break;
+                case '*': x *= y; break;
+                case '/': 
+                    if (y.isZero())
+                    {
+                        newA->_at(i) = Float::create(DPDFloat::posInf());
+                        continue;
+                    }
+                    x /= y; 
+                    break;
+                }
+                newA->_at(i) = ComplexN::create(x);
+            }
+        }
+        else return false;
+    }
+    newA->_initFlags();
+    res = r;
+    return true;
+}
+
+void opArrayScalar(TermRef& res, Array* a, Number* b, const char* op)
 { 
     unsigned int i;
+
+    /* numeric vectors and matrices go direct */
+    if (opArrayScalarN(res, a, b, *op)) return;
+
+    TermRef sym = currentTC->internSymbol(op, 1);
     if (sym) 
     {
         int n = 1;
@@ -2538,8 +2761,7 @@ void opArrayScalar(TermRef& res, Array* a, Number* b, TermRef sym)
 
 void addArrayScalar(TermRef& res, Array* a, Number* b)
 { 
-    TermRef sym = currentTC->internSymbol("+", 1);
-    opArrayScalar(res, a, b, sym);
+    opArrayScalar(res, a, b, "+");
 }
 
 void addScalarArray(TermRef& res, Number* a, Array* b)
@@ -2549,8 +2771,7 @@ void addScalarArray(TermRef& res, Number* a, Array* b)
 
 void mulArrayScalar(TermRef& res, Array* a, Number* b)
 { 
-    TermRef sym = currentTC->internSymbol("*", 1);
-    opArrayScalar(res, a, b, sym);
+    opArrayScalar(res, a, b, "*");
 }
 
 void mulScalarArray(TermRef& res, Number* a, Array* b)
@@ -2560,20 +2781,17 @@ void mulScalarArray(TermRef& res, Number* a, Array* b)
 
 void subArrayScalar(TermRef& res, Array* a, Number* b)
 { 
-    TermRef sym = currentTC->internSymbol("-", 1);
-    opArrayScalar(res, a, b, sym);
+    opArrayScalar(res, a, b, "-");
 }
 
 void divArrayScalar(TermRef& res, Array* a, Number* b)
 { 
-    TermRef sym = currentTC->internSymbol("/", 1);
-    opArrayScalar(res, a, b, sym);
+    opArrayScalar(res, a, b, "/");
 }
 
 void negArray(TermRef& res, Array* a)
 {
-    TermRef sym = currentTC->internSymbol("-", 1);
-    opArrayScalar(res, a, 0, sym);
+    opArrayScalar(res, a, 0, "-");
 }
 
 void invArray(TermRef& res, Array* a)
@@ -2681,6 +2899,118 @@ void prootArray(TermRef& res, Array* a)
     }
 }
 
+void eigenArray(TermRef& res, Array* a)
+{
+    if (a->isRealVecMat())
+    {
+        Matrix mc;
+        if (eigenvalues(Matrix(a), mc))
+            res = mc._a;
+    }
+}
+
+void svdArray(TermRef& res, Array* a)
+{
+    /* [u w v] with a = u.diag(w).v^T */
+    if (a->isRealVecMat())
+    {
+        Matrix u, w, v;
+        if (Matrix(a).svd(u, w, v))
+        {
+            Array* r = Array::create(3);
+            r->_at(0) = u._a;
+            r->_at(1) = w._a;
+            r->_at(2) = v._a;
+            r->_initFlags();
+            res = r;
+        }
+    }
+}
+
+/** SparseMatrix ************************************************/
+
+void sparseArray(TermRef& res, Array* a)
+{
+    if (a->isRealVecMat()) sparse(Matrix(a), res);
+}
+
+void sparseTriplets(TermRef& res, Array* ri, Array* ci, Array* v)
+{
+    // sparse(i, j, v), v[k] at row i[k] column j[k]
+    if (ri->isRealVecMat() && ci->isRealVecMat() && v->isRealVecMat())
+        sparse(Matrix(ri), Matrix(ci), Matrix(v), res);
+}
+
+void denseSparse(TermRef& res, SparseMatrix* a)
+{
+    Matrix mc;
+    dense(*a, mc);
+    res = mc._a;
+}
+
+void transposeSparse(TermRef& res, SparseMatrix* a)
+{
+    transpose(*a, res);
+}
+
+void negSparse(TermRef& res, SparseMatrix* a)
+{
+    mul(*a, BCD(-1), res);
+}
+
+void addSparseSparse(TermRef& res, SparseMatrix* a, SparseMatrix* b)
+{
+    add(*a, *b, res);
+}
+
+void subSparseSparse(TermRef& res, SparseMatrix* a, SparseMatrix* b)
+{
+    TermRef t;
+    negSparse(t, b);
+    add(*a, *SPARSE(t), res);
+}
+
+void mulSparseSparse(TermRef& res, SparseMatrix* a, SparseMatrix* b)
+{
+    mul(*a, *b, res);
+}
+
+void mulSparseArray(TermRef& res, SparseMatrix* a, Array* b)
+{
+    if (b->isRealVecMat())
+    {
+        Matrix mc;
+        if (mul(*a, Matrix(b), mc))
+            res = mc._a;
+    }
+}
+
+void mulSparseFloat(TermRef& res, SparseMatrix* a, Float* b)
+{
+    mul(*a, b->v_, res);
+}
+
+void mulFloatSparse(TermRef& res, Float* a, SparseMatrix* b)
+{
+    mul(*b, a->v_, res);
+}
+
+void divSparseFloat(TermRef& res, SparseMatrix* a, Float* b)
+{
+    if (!b->v_.isZero())
+        mul(*a, 1/b->v_, res);
+}
+
+void divArraySparse(TermRef& res, Array* a, SparseMatrix* b)
+{
+    if (a->isRealVecMat())
+    {
+        Matrix mc;
+        if (div(Matrix(a), *b, mc))
+            res = mc._a;
+    }
+}
+
 /****************************************************************/
 
 static const Fn1ImplRec InitialFn1ConvTable[] =
@@ -2693,6 +3023,7 @@ static const Fn1ImplRec InitialFn1ConvTable[] =
 static const Fn0ImplRec InitialFn0ImplTable[] =
 {
     { "pi", FLOAT_TYPE, (FnImpl*)piMF },
+    { "memstat", ARRAY_TYPE, (FnImpl*)memStatArray },
 };
 
 static const Fn1ImplRec InitialFn1ImplTable[] =
@@ -2766,12 +3097,36 @@ static const Fn1ImplRec InitialFn1ImplTable[] =
     { "cubeRoot", COMPLEX_TYPE, (FnImpl1*)cubeRootComplex, COMPLEX_TYPE },
     { "purge", EXPRESSION_TYPE, (FnImpl1*)purgeExpr, EXPRESSION_TYPE },
     { "proot", ARRAY_TYPE, (FnImpl1*)prootArray, ARRAY_TYPE },
+    { "eigen", ARRAY_TYPE, (FnImpl1*)eigenArray, ARRAY_TYPE },
+    { "svd", ARRAY_TYPE, (FnImpl1*)svdArray, ARRAY_TYPE },
+    { "sparse", SPARSE_TYPE, (FnImpl1*)sparseArray, ARRAY_TYPE },
+    { "dense", ARRAY_TYPE, (FnImpl1*)denseSparse, SPARSE_TYPE },
+    { "T", SPARSE_TYPE, (FnImpl1*)transposeSparse, SPARSE_TYPE },
+    { "-", SPARSE_TYPE, (FnImpl1*)negSparse, SPARSE_TYPE },
     { "mjd", FLOAT_TYPE, (FnImpl1*)mjdFloat, FLOAT_TYPE },
     { "date", FLOAT_TYPE, (FnImpl1*)dateFloat, FLOAT_TYPE },
     { "prime", RATIONAL_TYPE, (FnImpl1*)isPrimeRational, RATIONAL_TYPE },
     { "conj", COMPLEX_TYPE, (FnImpl1*)conjComplex, COMPLEX_TYPE },
     { "np", RATIONAL_TYPE, (FnImpl1*)nextPrimeRational, RATIONAL_TYPE },
     { "pp", RATIONAL_TYPE, (FnImpl1*)prevPrimeRational, RATIONAL_TYPE },
+    { "ptest", RATIONAL_TYPE, (FnImpl1*)primeTestRational, RATIONAL_TYPE },
+    { "digits", RATIONAL_TYPE, (FnImpl1*)digitsRational, RATIONAL_TYPE },
+    { "prec", RATIONAL_TYPE, (FnImpl1*)precRational, RATIONAL_TYPE },
+    { "lazy", RATIONAL_TYPE, (FnImpl1*)lazyRational, RATIONAL_TYPE },
+    { "vexp", STRING_TYPE, (FnImpl1*)vexpFn, FLOAT_TYPE },
+    { "vexp", STRING_TYPE, (FnImpl1*)vexpFn, STRING_TYPE },
+    { "vln", STRING_TYPE, (FnImpl1*)vlnFn, FLOAT_TYPE },
+    { "vln", STRING_TYPE, (FnImpl1*)vlnFn, STRING_TYPE },
+    { "vsqrt", STRING_TYPE, (FnImpl1*)vsqrtFn, FLOAT_TYPE },
+    { "vsqrt", STRING_TYPE, (FnImpl1*)vsqrtFn, STRING_TYPE },
+    { "vsin", STRING_TYPE, (FnImpl1*)vsinFn, FLOAT_TYPE },
+    { "vsin", STRING_TYPE, (FnImpl1*)vsinFn, STRING_TYPE },
+    { "vcos", STRING_TYPE, (FnImpl1*)vcosFn, FLOAT_TYPE },
+    { "vcos", STRING_TYPE, (FnImpl1*)vcosFn, STRING_TYPE },
+    { "vatan", STRING_TYPE, (FnImpl1*)vatanFn, FLOAT_TYPE },
+    { "vatan", STRING_TYPE, (FnImpl1*)vatanFn, STRING_TYPE },
+    { "vfac", STRING_TYPE, (FnImpl1*)vfacFn, FLOAT_TYPE },
+    { "vfac", STRING_TYPE, (FnImpl1*)vfacFn, STRING_TYPE },
     { "floor", FLOAT_TYPE, (FnImpl1*)floorFloat, FLOAT_TYPE },
     { "int", FLOAT_TYPE, (FnImpl1*)floorFloat, FLOAT_TYPE },
     { "ran", RATIONAL_TYPE, (FnImpl1*)ranRational, RATIONAL_TYPE },
@@ -2823,6 +3178,15 @@ static const Fn2ImplRec InitialFn2ImplTable[] =
     { "/", ARRAY_TYPE, (FnImpl2*)divScalarArray, NUMBER_TYPE, ARRAY_TYPE },
     { "/", ARRAY_TYPE, (FnImpl2*)divArrayArray, ARRAY_TYPE, ARRAY_TYPE },
 
+    { "+", SPARSE_TYPE, (FnImpl2*)addSparseSparse, SPARSE_TYPE, SPARSE_TYPE },
+    { "-", SPARSE_TYPE, (FnImpl2*)subSparseSparse, SPARSE_TYPE, SPARSE_TYPE },
+    { "*", SPARSE_TYPE, (FnImpl2*)mulSparseSparse, SPARSE_TYPE, SPARSE_TYPE },
+    { "*", ARRAY_TYPE, (FnImpl2*)mulSparseArray, SPARSE_TYPE, ARRAY_TYPE },
+    { "*", SPARSE_TYPE, (FnImpl2*)mulSparseFloat, SPARSE_TYPE, FLOAT_TYPE },
+    { "*", SPARSE_TYPE, (FnImpl2*)mulFloatSparse, FLOAT_TYPE, SPARSE_TYPE },
+    { "/", SPARSE_TYPE, (FnImpl2*)divSparseFloat, SPARSE_TYPE, FLOAT_TYPE },
+    { "/", ARRAY_TYPE, (FnImpl2*)divArraySparse, ARRAY_TYPE, SPARSE_TYPE },
+
     { "mod", RATIONAL_TYPE, (FnImpl2*)modRational, RATIONAL_TYPE, RATIONAL_TYPE },
     { "mod", FLOAT_TYPE, (FnImpl2*)modFloat, FLOAT_TYPE, FLOAT_TYPE },
 
@@ -2851,6 +3215,10 @@ static const FnnImplRec InitialFnnImplTable[] =
       FLOAT_TYPE, FLOAT_TYPE, FLOAT_TYPE
     },
 
+    { "sparse", SPARSE_TYPE, (FnImpl*)sparseTriplets, 3,
+      ARRAY_TYPE, ARRAY_TYPE, ARRAY_TYPE
+    },
+
     { "plot3d", EXPRESSION_TYPE, (FnImpl*)plot3DExpr, 5,
       EXPRESSION_TYPE,
       FLOAT_TYPE, FLOAT_TYPE,
@@ -46,8 +46,9 @@
 #define OPERATOR_TYPE           37
 #define FLOAT_TYPE              (41*REAL_TYPE)
 #define ARRAY_TYPE              43
+#define SPARSE_TYPE             53
 
-/* 53, 59, 61 */
+/* 59, 61 */
 
 #define ISFUNCTION(_x)          ((_x)->type() == FUNCTION_TYPE)
 #define ISOPERATOR(_x)          ((_x)->type() == OPERATOR_TYPE)
@@ -58,6 +59,7 @@
 #define ISFLOAT(_x)             ((_x)->type() == FLOAT_TYPE)
 #define ISARRAY(_x)             ((_x)->type() == ARRAY_TYPE)
 #define ISCOMPLEX(_x)           ((_x)->type() == COMPLEX_TYPE)
+#define ISSPARSE(_x)            ((_x)->type() == SPARSE_TYPE)
 
 #define R(_x) ((Rational*)(_x))
 #define F(_x) ((Float*)(_x))
@@ -107,6 +109,7 @@ extern void InitFunctions();
 #define LABEL(_x)              ((Label*)((_x).ref_))
 #define FLOAT(_x)              ((Float*)((_x).ref_))
 #define ARRAY(_x)              ((Array*)((_x).ref_))
+#define SPARSE(_x)             ((SparseMatrix*)((_x).ref_))
 #define FUNCTION(_x)           ((Function*)((_x).ref_))
 #define COMPLEX(_x)            ((ComplexN*)((_x).ref_))
 
@@ -565,6 +568,50 @@ struct Array: public Term
     TermRef                     elts_[1]; // first element
 };
 
+struct SparseMatrix: public Term
+{
+    /* real matrix in compressed sparse row form. only the nonzero
+     * entries are held, row `i' being cols_[k], vals_[k] for
+     * rows_[i] <= k < rows_[i+1] with columns ascending.
+     * like numbers, these are never modified once built.
+     */
+    SparseMatrix()
+    {
+        nRows_ = 0;
+        nCols_ = 0;
+        nnz_ = 0;
+        rows_ = 0;
+        cols_ = 0;
+        vals_ = 0;
+    }
+
+    ~SparseMatrix()
+    {
+        delete [] rows_;
+        delete [] cols_;
+        delete [] vals_;
+    }
+
+    // Term compliance
+    Type                        type() const { return mytype(); }
+    static Type                 mytype() { return SPARSE_TYPE; }
+    void                        asString(TermRef& s, DispFormat*) const;
+    TermRef                     clone() { return this; }
+
+    // Features
+    static SparseMatrix*        create(unsigned int nRows,
+                                       unsigned int nCols,
+                                       unsigned int nnz);
+    bool                        isSquare() const { return nRows_ == nCols_; }
+
+    unsigned short              nRows_;
+    unsigned short              nCols_;
+    unsigned int                nnz_;
+    unsigned int*               rows_;  // nRows_+1 row starts
+    unsigned short*             cols_;
+    BCD*                        vals_;
+};
+
 /****************************************************************/
 
 struct RegInfo